@@ -0,0 +1,549 @@
+//---------------------------------------------------------------------------
+// NAME: Joey Macauley
+// FILE: arenaseq.h
+// DATE: CPSC 223 - Spring 2022
+// DESC: Linked list implementation of Sequence whose nodes live in one
+//       contiguous arena and link to each other by 32-bit index
+//       instead of by pointer. Values and links are kept in two
+//       parallel arrays, so a node costs sizeof(T) + 4 bytes with no
+//       padding (8 bytes for an int, against 16 for a LinkedSeq
+//       node). Because links are indices, the arena can grow by
+//       realloc and a list of trivially copyable values is copied
+//       with two memcpys. Erased nodes go on a free list threaded
+//       through the links and are reused. The sorts are the ones
+//       LinkedSeq uses (listsort.h), relinking indices only; values
+//       never move.
+//---------------------------------------------------------------------------
+
+#ifndef ARENASEQ_H
+#define ARENASEQ_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "listsort.h"
+#include "sequence.h"
+#include "sortkey.h"
+
+template <typename T>
+class ArenaSeq : public Sequence<T>
+{
+public:
+  // Default constructor
+  ArenaSeq();
+
+  // Copy constructor
+  ArenaSeq(const ArenaSeq &rhs);
+
+  // Move constructor
+  ArenaSeq(ArenaSeq &&rhs);
+
+  // Copy assignment operator
+  ArenaSeq &operator=(const ArenaSeq &rhs);
+
+  // Move assignment operator
+  ArenaSeq &operator=(ArenaSeq &&rhs);
+
+  // Destructor
+  ~ArenaSeq();
+
+  // Returns the number of elements in the sequence
+  int size() const override;
+
+  // Tests if the sequence is empty
+  bool empty() const override;
+
+  // Removes all of the elements from the sequence and frees the arena
+  void clear() override;
+
+  // Returns a reference to the element at the index in the
+  // sequence. Throws out_of_range if index is invalid.
+  T &operator[](int index) override;
+
+  // Returns a constant address to the element at the index in the
+  // sequence. Throws out_of_range if index is invalid.
+  const T &operator[](int index) const override;
+
+  // Extends the sequence by inserting the element at the given
+  // index. Throws out_of_range if the index is invalid.
+  void insert(const T &elem, int index) override;
+
+  // Same as above, but moves the element into the new node instead of
+  // copying it
+  void insert(T &&elem, int index);
+
+  // Shrinks the sequence by removing the element at the index in the
+  // sequence. Throws out_of_range if index is invalid.
+  void erase(int index) override;
+
+  // Returns true if the element is in the sequence, and false
+  // otherwise.
+  bool contains(const T &elem) const override;
+
+  // Makes room in the arena for at least n nodes
+  void reserve(int n) override;
+
+  // Sorts the elements in the sequence in place using less than equal
+  // (<=) operator. Uses merge sort.
+  void sort() override;
+
+  // Sorts the sequence in place using bottom-up merge sort (shared
+  // with LinkedSeq::bottom_up_merge_sort()). Takes the same optional
+  // comparator and projection as the LinkedSeq sorts (see sortkey.h).
+  // Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void merge_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using three-way quick sort around a
+  // median of three pivot (shared with
+  // LinkedSeq::three_way_quick_sort()).
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void quick_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Returns the number of nodes the arena has room for
+  int storage_capacity() const;
+
+  // Returns the bytes used by the arena
+  long long memory_bytes() const;
+
+private:
+  // node index, NIL ends a list
+  typedef std::uint32_t Link;
+  static const Link NIL = UINT32_MAX;
+
+  // values[i] and links[i] make up node i. values are constructed
+  // only for nodes in the list; links of free nodes chain the free
+  // list.
+  T *values = nullptr;
+  Link *links = nullptr;
+
+  // arena size in nodes, and nodes handed out since the last clear
+  int capacity = 0;
+  int used = 0;
+
+  // first node, last node, and first free node
+  Link head = NIL;
+  Link tail = NIL;
+  Link free_head = NIL;
+
+  // size of list
+  int count = 0;
+
+  // trivially copyable values are kept in malloc'd storage so the
+  // arena can be grown with realloc and copied with memcpy
+  static const bool RELOCATE_BY_REALLOC =
+      std::is_trivially_copyable<T>::value and
+      alignof(T) <= alignof(std::max_align_t);
+
+  // first arena size
+  static const int MIN_CAPACITY = 8;
+
+  // moves the nodes into an arena of new_capacity nodes
+  void reallocate(int new_capacity);
+
+  // builds a node holding elem, and destroys and frees one
+  Link make_node(T &&elem);
+  void free_node(Link node);
+
+  // returns the node at index
+  Link node_at(int index) const;
+
+  // link policy that lets the shared sorts in listsort.h relink
+  // nodes by index
+  struct IndexLinks
+  {
+    typedef std::uint32_t Link;
+    T *values;
+    Link *links;
+    Link nil() const { return NIL; }
+    Link next(Link node) const { return links[node]; }
+    void set_next(Link node, Link next) const { links[node] = next; }
+    const T &value(Link node) const { return values[node]; }
+    void prefetch(Link node) const
+    {
+      if (node != NIL)
+      {
+        __builtin_prefetch(values + node);
+        __builtin_prefetch(links + node);
+      }
+    }
+  };
+};
+
+template <typename T>
+std::ostream &operator<<(std::ostream &stream, const ArenaSeq<T> &seq)
+{
+  int n = seq.size();
+  for (int i = 0; i < n - 1; ++i)
+    stream << seq[i] << ", ";
+  if (n > 0)
+    stream << seq[n - 1];
+  return stream;
+}
+
+template <typename T>
+ArenaSeq<T>::ArenaSeq()
+{
+}
+
+template <typename T>
+ArenaSeq<T>::ArenaSeq(const ArenaSeq &rhs)
+{
+  *this = rhs;
+}
+
+template <typename T>
+ArenaSeq<T>::ArenaSeq(ArenaSeq &&rhs)
+{
+  *this = std::move(rhs);
+}
+
+template <typename T>
+ArenaSeq<T> &ArenaSeq<T>::operator=(const ArenaSeq &rhs)
+{
+  if (this != &rhs)
+  {
+    clear();
+    if constexpr (RELOCATE_BY_REALLOC)
+    {
+      // the links are positions, so the arena copies as is
+      if (rhs.used > 0)
+      {
+        reallocate(rhs.used);
+        std::memcpy(values, rhs.values, sizeof(T) * static_cast<size_t>(rhs.used));
+        std::memcpy(links, rhs.links, sizeof(Link) * static_cast<size_t>(rhs.used));
+      }
+      used = rhs.used;
+      head = rhs.head;
+      tail = rhs.tail;
+      free_head = rhs.free_head;
+      count = rhs.count;
+    }
+    else
+    {
+      reserve(rhs.count);
+      for (Link node = rhs.head; node != NIL; node = rhs.links[node])
+      {
+        insert(rhs.values[node], count);
+      }
+    }
+  }
+  return *this;
+}
+
+template <typename T>
+ArenaSeq<T> &ArenaSeq<T>::operator=(ArenaSeq &&rhs)
+{
+  if (this != &rhs)
+  {
+    clear();
+    values = rhs.values;
+    links = rhs.links;
+    capacity = rhs.capacity;
+    used = rhs.used;
+    head = rhs.head;
+    tail = rhs.tail;
+    free_head = rhs.free_head;
+    count = rhs.count;
+
+    rhs.values = nullptr;
+    rhs.links = nullptr;
+    rhs.capacity = 0;
+    rhs.used = 0;
+    rhs.head = NIL;
+    rhs.tail = NIL;
+    rhs.free_head = NIL;
+    rhs.count = 0;
+  }
+  return *this;
+}
+
+template <typename T>
+ArenaSeq<T>::~ArenaSeq()
+{
+  clear();
+}
+
+template <typename T>
+int ArenaSeq<T>::size() const
+{
+  return count;
+}
+
+template <typename T>
+bool ArenaSeq<T>::empty() const
+{
+  return count == 0;
+}
+
+template <typename T>
+void ArenaSeq<T>::clear()
+{
+  if constexpr (not std::is_trivially_destructible<T>::value)
+  {
+    for (Link node = head; node != NIL; node = links[node])
+    {
+      values[node].~T();
+    }
+  }
+  if constexpr (RELOCATE_BY_REALLOC)
+  {
+    std::free(values);
+  }
+  else if (values != nullptr)
+  {
+    std::allocator<T>().deallocate(values, capacity);
+  }
+  std::free(links);
+  values = nullptr;
+  links = nullptr;
+  capacity = 0;
+  used = 0;
+  head = NIL;
+  tail = NIL;
+  free_head = NIL;
+  count = 0;
+}
+
+template <typename T>
+T &ArenaSeq<T>::operator[](int index)
+{
+  if (index < 0 or index >= size())
+  {
+    throw std::out_of_range("Invalid index");
+  }
+  return values[node_at(index)];
+}
+
+template <typename T>
+const T &ArenaSeq<T>::operator[](int index) const
+{
+  if (index < 0 or index >= size())
+  {
+    throw std::out_of_range("Invalid index");
+  }
+  return values[node_at(index)];
+}
+
+template <typename T>
+void ArenaSeq<T>::insert(const T &elem, int index)
+{
+  insert(T(elem), index);
+}
+
+template <typename T>
+void ArenaSeq<T>::insert(T &&elem, int index)
+{
+  if (index < 0 or index > size())
+  {
+    throw std::out_of_range("Invalid index");
+  }
+
+  Link node = make_node(std::move(elem));
+  if (empty())
+  {
+    head = node;
+    tail = node;
+  }
+  else if (index == 0)
+  {
+    links[node] = head;
+    head = node;
+  }
+  else if (index == size())
+  {
+    links[tail] = node;
+    tail = node;
+  }
+  else
+  {
+    Link prev = node_at(index - 1);
+    links[node] = links[prev];
+    links[prev] = node;
+  }
+  ++count;
+}
+
+template <typename T>
+void ArenaSeq<T>::erase(int index)
+{
+  if (index < 0 or index >= size())
+  {
+    throw std::out_of_range("Invalid index");
+  }
+
+  Link remove = head;
+  if (index == 0)
+  {
+    head = links[remove];
+    if (head == NIL)
+    {
+      tail = NIL;
+    }
+  }
+  else
+  {
+    Link prev = node_at(index - 1);
+    remove = links[prev];
+    links[prev] = links[remove];
+    if (remove == tail)
+    {
+      tail = prev;
+    }
+  }
+  free_node(remove);
+  --count;
+}
+
+template <typename T>
+bool ArenaSeq<T>::contains(const T &elem) const
+{
+  for (Link node = head; node != NIL; node = links[node])
+  {
+    if (values[node] == elem)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T>
+void ArenaSeq<T>::reserve(int n)
+{
+  if (n > capacity)
+  {
+    reallocate(n);
+  }
+}
+
+template <typename T>
+void ArenaSeq<T>::sort()
+{
+  merge_sort();
+}
+
+template <typename T>
+int ArenaSeq<T>::storage_capacity() const
+{
+  return capacity;
+}
+
+template <typename T>
+long long ArenaSeq<T>::memory_bytes() const
+{
+  return (long long)capacity * (sizeof(T) + sizeof(Link));
+}
+
+template <typename T>
+void ArenaSeq<T>::reallocate(int new_capacity)
+{
+  void *moved_links = std::realloc(links, sizeof(Link) * static_cast<size_t>(new_capacity));
+  if (moved_links == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  links = static_cast<Link *>(moved_links);
+
+  if constexpr (RELOCATE_BY_REALLOC)
+  {
+    void *moved = std::realloc(values, sizeof(T) * static_cast<size_t>(new_capacity));
+    if (moved == nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    values = static_cast<T *>(moved);
+  }
+  else
+  {
+    // only nodes in the list hold values; each keeps its index
+    T *new_values = std::allocator<T>().allocate(new_capacity);
+    for (Link node = head; node != NIL; node = links[node])
+    {
+      new (new_values + node) T(std::move(values[node]));
+      values[node].~T();
+    }
+    if (values != nullptr)
+    {
+      std::allocator<T>().deallocate(values, capacity);
+    }
+    values = new_values;
+  }
+  capacity = new_capacity;
+}
+
+template <typename T>
+typename ArenaSeq<T>::Link ArenaSeq<T>::make_node(T &&elem)
+{
+  Link node = free_head;
+  if (node != NIL)
+  {
+    free_head = links[node];
+  }
+  else
+  {
+    if (used == capacity)
+    {
+      reallocate(capacity < MIN_CAPACITY ? MIN_CAPACITY : 2 * capacity);
+    }
+    node = used++;
+  }
+  new (values + node) T(std::move(elem));
+  links[node] = NIL;
+  return node;
+}
+
+template <typename T>
+void ArenaSeq<T>::free_node(Link node)
+{
+  values[node].~T();
+  links[node] = free_head;
+  free_head = node;
+}
+
+template <typename T>
+typename ArenaSeq<T>::Link ArenaSeq<T>::node_at(int index) const
+{
+  if (index == count - 1)
+  {
+    return tail;
+  }
+  Link node = head;
+  for (int i = 0; i < index; ++i)
+  {
+    node = links[node];
+  }
+  return node;
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArenaSeq<T>::merge_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  head = list_bottom_up_merge_sort(IndexLinks{values, links}, head, less);
+
+  tail = head;
+  while (tail != NIL and links[tail] != NIL)
+  {
+    tail = links[tail];
+  }
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArenaSeq<T>::quick_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  Link last = NIL;
+  head = list_three_way_quick_sort(IndexLinks{values, links}, head, size(), last, less);
+  tail = last;
+}
+
+#endif
@@ -10,7 +10,22 @@
 
 #include <stdexcept>
 #include <ostream>
+#include <utility>
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <thread>
+#include <atomic>
+#include <vector>
 #include "sequence.h"
+#include "linkedseq.h"
+#include "simdscan.h"
+#include "sortkey.h"
+#include "workpool.h"
 
 template <typename T>
 class ArraySeq : public Sequence<T>
@@ -40,12 +55,31 @@ public:
   // Tests if the sequence is empty
   bool empty() const;
 
-  // Removes all of the elements from the sequence
+  // Removes all of the elements from the sequence and releases its
+  // storage
   void clear();
 
+  // Makes room for at least n elements, so inserting up to n does not
+  // reallocate. Does nothing if the capacity is already at least n.
+  void reserve(int n);
+
+  // Releases unused capacity, so the storage holds exactly size()
+  // elements
+  void shrink_to_fit();
+
+  // Returns the number of elements the storage has room for
+  int storage_capacity() const;
+
+  // Sets the factor the capacity is multiplied by when an insert runs
+  // out of room (2 by default). Throws invalid_argument unless the
+  // factor is greater than 1.
+  void set_growth_factor(double factor);
+
   // Returns a reference to the element at the index in the
   // sequence. Throws out_of_range if index is invalid (less than 0 or
-  // greater than or equal to size()).
+  // greater than or equal to size()). Since the element may be
+  // changed through the reference, clears the sorted flag (see
+  // is_sorted()).
   T &operator[](int index);
 
   // Returns a constant address to the element at the index in the
@@ -58,32 +92,240 @@ public:
   // greater than size()).
   void insert(const T &elem, int index);
 
+  // Same as above, but moves the element into the sequence instead of
+  // copying it
+  void insert(T &&elem, int index);
+
   // Shrinks the sequence by removing the element at the index in the
   // sequence. Throws out_of_range if index is invalid.
   void erase(int index);
 
   // Returns true if the element is in the sequence, and false
-  // otherwise.
+  // otherwise. Uses binary search when the sequence is known to be
+  // sorted (see is_sorted()), and a linear scan otherwise, which is
+  // vectorized for int, float and double (see simdscan.h).
   bool contains(const T &elem) const;
 
   // Sorts the elements in the sequence in place using less than equal
-  // (<=) operator. Uses quick sort with a randomly selected pivot
-  // index.
+  // (<=) operator. Uses radix sort for integral element types once
+  // the sequence is large enough for it to pay off, and intro sort
+  // (see intro_sort()) otherwise. Returns immediately if the sequence
+  // is known to be sorted already.
   void sort();
 
+  // Returns true if the sequence is known to be sorted in natural (<)
+  // order. The flag is set by any sort in natural order (comparator
+  // std::less and no projection) and by verify_sorted(), kept by
+  // erase(), and cleared by insert(), the non-const operator[], and
+  // any other reordering. An empty sequence counts as sorted.
+  bool is_sorted() const;
+
+  // Checks in O(n) whether the sequence is sorted in natural order,
+  // updates the flag returned by is_sorted() to match, and returns it.
+  bool verify_sorted();
+
+  // Returns the index of the first element not less than elem, or
+  // size() if there is none. The next two return the index of the
+  // first element greater than elem, and the pair of both (the range
+  // of elements equal to elem). All three binary search, and throw
+  // logic_error unless is_sorted().
+  int lower_bound(const T &elem) const;
+  int upper_bound(const T &elem) const;
+  std::pair<int, int> equal_range(const T &elem) const;
+
+  // Every sort below also takes an optional comparator and key
+  // projection (see sortkey.h) and orders elements a and b by
+  // comp(proj(a), proj(b)), e.g. sort(std::greater<>()) or
+  // tim_sort(std::less<>(), &Record::timestamp).
+
+  // Same as sort() but ordered by comp and proj. Radix sort is only
+  // used when comp is std::less and the keys are integral.
+  template <typename Compare, typename Project = Identity>
+  void sort(Compare comp, Project proj = Project());
+
   // Sorts the sequence in place using the merge sort algorithm.
-  void merge_sort();
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void merge_sort(Compare comp = Compare(), Project proj = Project());
 
   // Sorts the sequence in place using the quick sort algorithm. Uses
   // first element for pivot values.
-  void quick_sort();
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void quick_sort(Compare comp = Compare(), Project proj = Project());
 
   // Sorts the sequence in place using the quick sort algorithm. Uses
   // randomly selected indexes for pivot values.
-  void quick_sort_random();
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void quick_sort_random(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using Yaroslavskiy's dual-pivot quick
+  // sort. The two pivots are the second and fourth of five sorted
+  // sample elements, and one scan splits each range into three parts
+  // (less than the first pivot, between the pivots, greater than the
+  // second). If the pivots are equal the range is partitioned three
+  // ways around that value instead.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void dual_pivot_quick_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using introspective sort: quick sort
+  // with median-of-three pivots that falls back to heap sort once the
+  // recursion depth passes 2*log2(n), and finishes small partitions
+  // with insertion sort. Worst case O(n log n).
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void intro_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using pattern-defeating quick sort
+  // with a branchless block partition: comparison results are
+  // collected into offset buffers and misplaced elements are swapped
+  // a block at a time. Unbalanced partitions are broken up by
+  // swapping elements around, and heap sort is used after log2(n) bad
+  // partitions. Worst case O(n log n).
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void block_quick_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using merge sort with one auxiliary
+  // buffer allocated up front. Each level of the recursion merges
+  // from the array into the buffer or back, alternating, so there is
+  // no per-merge allocation and no copy-back pass. Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void buffered_merge_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Same as buffered_merge_sort() but uses the caller's scratch
+  // buffer so it can be reused across sorts. Throws invalid_argument
+  // if scratch is null or scratch_size is less than size().
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void buffered_merge_sort(T *scratch, int scratch_size, Compare comp = Compare(),
+                           Project proj = Project());
+
+  // Sorts the sequence in place using iterative (bottom-up) merge
+  // sort. Short runs are insertion sorted, then passes of doubling
+  // width merge neighboring runs between the array and one auxiliary
+  // buffer. Does not recurse. Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void bottom_up_merge_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using Timsort, an adaptive merge
+  // sort. Existing ascending and strictly descending runs are found
+  // (descending ones are reversed), short runs are extended with
+  // binary insertion sort, and runs are merged with galloping once
+  // one side keeps winning. Sorted and reverse sorted input take
+  // O(n). Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void tim_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using LSD radix sort, one byte per
+  // pass. All digit histograms are built in a single counting pass,
+  // the sign bit is flipped so negative values order first, and
+  // passes where every element has the same digit are skipped. Takes
+  // a projection but no comparator, and is only available when the
+  // keys are of an integral (non-bool) type. Stable.
+  template <typename Project = Identity>
+  void radix_sort(Project proj = Project());
+
+  // Sorts the sequence in place using LSD radix sort split across the
+  // given number of threads (0 uses every hardware thread). Each pass
+  // builds per-thread digit histograms over a slice of the data, a
+  // global prefix sum gives each thread its scatter offsets, and
+  // threads scatter through small per-digit staging buffers so writes
+  // go out a cache line at a time. Small inputs fall back to
+  // radix_sort(). Like radix_sort(), takes only a projection to an
+  // integral (non-bool) key. Stable.
+  template <typename Project = Identity>
+  void parallel_radix_sort(int threads, Project proj = Project());
+
+  // Sorts the sequence in place using quick sort on a work-stealing
+  // thread pool with the given number of threads (0 uses every
+  // hardware thread). After each partition one side is pushed as a
+  // task for idle threads to steal. Partitions of 256K or more
+  // elements are themselves split across threads, and pieces below
+  // 16K are finished with block_quick_sort(). Worst case O(n log n).
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void parallel_quick_sort(int threads, Compare comp = Compare(),
+                           Project proj = Project());
+
+  // Sorts the sequence in place using merge sort across the given
+  // number of threads (0 uses every hardware thread). Each thread
+  // sorts one slice. Then rounds of pairwise merges follow, and in
+  // every round the output is cut into equal parts with merge path
+  // (co-rank) binary searches so each thread merges an independent
+  // piece, down to the final merge. Uses one auxiliary buffer.
+  // Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void parallel_merge_sort(int threads, Compare comp = Compare(),
+                           Project proj = Project());
+
+  // Sorts the sequence in place using sample sort across the given
+  // number of threads (0 uses every hardware thread). A random
+  // oversample picks splitters for a power-of-two number of buckets
+  // (at least twice the thread count). One streaming pass classifies
+  // every element by walking the splitters as an implicit search tree
+  // with no branches. When the sample repeats a splitter (many equal
+  // keys), each bucket gets a twin holding the keys equal to its upper
+  // splitter, which needs no sorting. A second pass moves each element
+  // into its bucket's slot in a new buffer, and the buckets are then
+  // sorted in parallel with block_quick_sort().
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void parallel_sample_sort(int threads, Compare comp = Compare(),
+                            Project proj = Project());
+
+  // Sorts the sequence in place using quick sort with three-way
+  // (Dutch national flag) partitioning around a median-of-three
+  // pivot (pseudo-median of nine on larger ranges). Keys equal to the
+  // pivot are grouped once and left out of both recursive calls, so
+  // all-equal and few-unique inputs take linear time.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void three_way_quick_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Returns the permutation that sorts the sequence without moving
+  // any elements: position i of the result holds the index of the
+  // element that belongs at i. Only the int indexes are moved, so this
+  // is much cheaper than sorting large elements directly. Arithmetic
+  // keys are copied out next to their indexes once and sorted there
+  // (by radix sort when they are integral in natural order). Takes the
+  // same optional comparator and projection as the sorts. Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  ArraySeq<int> argsort(Compare comp = Compare(), Project proj = Project()) const;
+
+  // Reorders the elements in place so the element at index perm[i]
+  // ends up at i, e.g. apply_permutation(argsort()) sorts the
+  // sequence. Each cycle of the permutation is followed once with a
+  // single temporary, so every element is moved exactly once. Throws
+  // invalid_argument if perm is not a permutation of 0..size()-1.
+  void apply_permutation(const ArraySeq<int> &perm);
+
+  // Rearranges the sequence so the element at index k is the one a
+  // full sort would put there, with no larger element before it and
+  // no smaller element after it, and returns that element. Uses
+  // introselect: quickselect around random pivots (the partition from
+  // quick_sort_random()), switching to median-of-medians pivots once
+  // 2*log2(n) partitions have not finished, so the worst case stays
+  // O(n). Throws out_of_range if k is not a valid index.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  T &select(int k, Compare comp = Compare(), Project proj = Project());
+
+  // Moves the k smallest elements to the front of the sequence in
+  // sorted order, leaving the rest in unspecified order after them.
+  // Runs select() for the k-th element and then sorts only the first
+  // k, so takes O(n + k log k). Throws out_of_range if k is less than
+  // 0 or greater than size().
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void partial_sort(int k, Compare comp = Compare(), Project proj = Project());
+
+  // Returns the k smallest elements in sorted order (all of them if k
+  // is at least size()) without changing the sequence. One pass
+  // streams every element past a max-heap of the best k seen so far,
+  // so takes O(n log k) time and O(k) extra space. Throws
+  // out_of_range if k is less than 0.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  LinkedSeq<T> top_k(int k, Compare comp = Compare(), Project proj = Project()) const;
 
 private:
-  // resizable array
+  // argsort() and apply_permutation() work on an ArraySeq<int>'s
+  // storage directly
+  template <typename U>
+  friend class ArraySeq;
+
+  // resizable array, only the first count slots hold constructed
+  // elements
   T *array = nullptr;
 
   // size of list
@@ -92,13 +334,205 @@ private:
   // max capacity of the array
   int capacity = 0;
 
-  // helper to double the capacity of the array
-  void resize();
+  // capacity multiplier when the array is full
+  double growth_factor = 2.0;
+
+  // true if the elements are known to be in natural order
+  bool sorted = true;
+
+  // sets sorted after a sort ordered by Compare and Project
+  template <typename Compare, typename Project>
+  void mark_sorted();
 
-  // sort function helpers
-  void merge_sort(int start, int end);
-  void quick_sort(int start, int end);
-  void quick_sort_random(int start, int end);
+  // grows the capacity by growth_factor, to at least min_capacity
+  void grow(int min_capacity);
+
+  // moves the elements into storage of exactly new_capacity
+  void reallocate(int new_capacity);
+
+  // uninitialized storage for n elements, and its release.
+  // Trivially copyable elements are kept in malloc'd storage so
+  // reallocate() can relocate them with realloc, without moves.
+  static const bool RELOCATE_BY_REALLOC =
+      std::is_trivially_copyable<T>::value and
+      alignof(T) <= alignof(std::max_align_t);
+  static T *allocate(int n);
+  static void deallocate(T *storage, int n);
+
+  // scratch space for the sorts, from allocate(). The sorts move
+  // assign into it, so every slot must hold a live T, but T need not
+  // be default constructible: each slot is made live by moving a
+  // donor element in and straight back, leaving a valid moved-from T.
+  // Trivial types are used as raw storage. The slots are destroyed
+  // and the storage freed when it goes out of scope, so a comparator
+  // or move that throws leaks nothing.
+  class Scratch
+  {
+  public:
+    // Empty scratch
+    Scratch();
+
+    // n live slots, made live from donor[0..donor_count)
+    Scratch(int n, T *donor, int donor_count);
+
+    // Scratch space is never copied
+    Scratch(const Scratch &rhs) = delete;
+    Scratch &operator=(const Scratch &rhs) = delete;
+
+    // Destroys the slots and frees the storage
+    ~Scratch();
+
+    // Replaces the storage with n live slots, as in the constructor
+    void reset(int n, T *donor, int donor_count);
+
+    // Returns the first slot
+    T *get() const;
+
+  private:
+    T *slots = nullptr;
+    int slot_capacity = 0;
+    int live = 0;
+  };
+
+  // first capacity grow() gives an empty sequence
+  static const int MIN_CAPACITY = 8;
+
+  // sort function helpers, less is the KeyLess ordering built from
+  // the caller's comparator and projection
+  template <typename Less>
+  void merge_sort(int start, int end, const Less &less);
+  template <typename Less>
+  void quick_sort(int start, int end, const Less &less);
+  template <typename Less>
+  void quick_sort_random(int start, int end, const Less &less);
+  template <typename Less>
+  int partition(int start, int end, int pivot_idx, const Less &less);
+  template <typename Less>
+  void select(int start, int end, int k, int depth_limit, const Less &less);
+  template <typename Less>
+  int median_of_medians(int start, int end, const Less &less);
+  template <typename Less>
+  void dual_pivot_quick_sort(int start, int end, const Less &less);
+  template <typename Less>
+  void intro_sort(int start, int end, int depth_limit, const Less &less);
+  template <typename Less>
+  void heap_sort(int start, int end, const Less &less);
+  template <typename Less>
+  void sift_down(int start, int root, int len, const Less &less);
+  template <typename Less>
+  void insertion_sort(int start, int end, const Less &less);
+
+  template <typename Less>
+  void block_quick_sort(int start, int end, int bad_allowed, bool leftmost,
+                        const Less &less);
+  template <typename Less>
+  int block_partition(int start, int end, bool &already_partitioned,
+                      const Less &less);
+  template <typename Less>
+  int partition_left(int start, int end, const Less &less);
+  template <typename Less>
+  bool partial_insertion_sort(int start, int end, const Less &less);
+  template <typename Less>
+  void sort3(int a, int b, int c, const Less &less);
+  template <typename Less>
+  void three_way_quick_sort(int start, int end, const Less &less);
+  template <typename Less>
+  void buffered_merge_sort(T *buffer, int start, int end, bool to_buffer,
+                           const Less &less);
+  template <typename Less>
+  static void merge_move(T *src, int start, int mid, int end, T *dst,
+                         const Less &less);
+  template <typename Less>
+  static void merge_move_ranges(T *src, int first, int first_end, int second,
+                                int second_end, T *dst, int out, const Less &less);
+  template <typename Less>
+  static int co_rank(int k, const T *src, int first, int first_len, int second,
+                     int second_len, const Less &less);
+
+  // tim_sort() pending runs and merge state
+  static const int TIM_MIN_MERGE = 32;
+  static const int TIM_MIN_GALLOP = 7;
+  static const int TIM_MAX_RUNS = 49;
+  struct TimState
+  {
+    int run_base[TIM_MAX_RUNS];
+    int run_len[TIM_MAX_RUNS];
+    int runs = 0;
+    Scratch tmp;
+    int tmp_size = 0;
+    int min_gallop = TIM_MIN_GALLOP;
+  };
+
+  template <typename Less>
+  int count_run(int lo, int hi, const Less &less);
+  template <typename Less>
+  void binary_insertion_sort(int lo, int hi, int start, const Less &less);
+  template <typename Less>
+  void tim_merge_collapse(TimState &state, const Less &less);
+  template <typename Less>
+  void tim_merge_at(TimState &state, int i, const Less &less);
+  template <typename Less>
+  void tim_merge_lo(TimState &state, int base1, int len1, int base2, int len2,
+                    const Less &less);
+  template <typename Less>
+  void tim_merge_hi(TimState &state, int base1, int len1, int base2, int len2,
+                    const Less &less);
+  T *tim_tmp(TimState &state, int len);
+  template <typename Less>
+  static int gallop_left(const T &key, const T *a, int base, int len, int hint,
+                         const Less &less);
+  template <typename Less>
+  static int gallop_right(const T &key, const T *a, int base, int len, int hint,
+                          const Less &less);
+
+  // runs fn(t) for t = 0..threads-1, each on its own thread
+  template <typename Fn>
+  static void run_threads(int threads, Fn fn);
+  static int thread_count(int threads);
+
+  template <typename Less>
+  void parallel_quick_sort(WorkStealingPool &pool, int worker, int start,
+                           int end, int depth_limit, const Less &less);
+  template <typename Less>
+  int parallel_partition(WorkStealingPool &pool, int worker, int start, int end,
+                         const T &pivot_val, bool equal_left, const Less &less);
+  template <typename Less>
+  int partition_chunk(int lo, int hi, const T &pivot_val, bool equal_left,
+                      const Less &less);
+
+  // parallel_quick_sort() sorts pieces at or below this size serially
+  static const int PARALLEL_SORT_CUTOFF = 1 << 14;
+
+  // parallel_quick_sort() splits partitions of this size or more
+  // across threads, in chunks of at least PARTITION_CHUNK_SIZE
+  static const int PARALLEL_PARTITION_CUTOFF = 1 << 18;
+  static const int PARTITION_CHUNK_SIZE = 1 << 16;
+
+  // parallel_merge_sort() gives each thread at least this many elements
+  static const int PARALLEL_MERGE_CUTOFF = 1 << 14;
+
+  // parallel_sample_sort() gives each thread at least this many
+  // elements, and samples this many elements per bucket
+  static const int PARALLEL_SAMPLE_CUTOFF = 1 << 16;
+  static const int SAMPLE_OVERSAMPLING = 16;
+
+  // parallel_radix_sort() falls back to radix_sort() below this size
+  static const int PARALLEL_RADIX_CUTOFF = 1 << 16;
+
+  // elements staged per digit before parallel_radix_sort() flushes
+  static const int RADIX_STAGE_SIZE = 16;
+
+  // sort() uses radix sort for integral types from this size on
+  static const int RADIX_SORT_CUTOFF = 256;
+
+  // partitions at or below this size are finished by insertion sort
+  static const int INSERTION_SORT_CUTOFF = 16;
+
+  // number of elements classified per block by block_partition()
+  static const int PARTITION_BLOCK_SIZE = 64;
+
+  // partitions larger than this use a pseudo-median of nine pivot
+  static const int NINTHER_CUTOFF = 128;
 
   // random seed for quick sort
   int seed = 22;
@@ -138,14 +572,11 @@ ArraySeq<T> &ArraySeq<T>::operator=(const ArraySeq &rhs)
   if (this != &rhs)
   {
     clear();
-    array = new T[rhs.capacity];
+    reserve(rhs.count);
+    std::uninitialized_copy(rhs.array, rhs.array + rhs.count, array);
     count = rhs.count;
-    capacity = rhs.capacity;
-
-    for (int i = 0; i < count; i++)
-    {
-      array[i] = rhs[i];
-    }
+    sorted = rhs.sorted;
+    growth_factor = rhs.growth_factor;
   }
   return *this;
 }
@@ -159,10 +590,13 @@ ArraySeq<T> &ArraySeq<T>::operator=(ArraySeq &&rhs)
     array = rhs.array;
     count = rhs.count;
     capacity = rhs.capacity;
+    sorted = rhs.sorted;
+    growth_factor = rhs.growth_factor;
 
     rhs.array = nullptr;
     rhs.count = 0;
     rhs.capacity = 0;
+    rhs.sorted = true;
   }
   return *this;
 }
@@ -192,10 +626,46 @@ bool ArraySeq<T>::empty() const
 template <typename T>
 void ArraySeq<T>::clear()
 {
+  std::destroy(array, array + count);
+  deallocate(array, capacity);
   count = 0;
   capacity = 0;
-  delete[] array;
   array = nullptr;
+  sorted = true;
+}
+
+template <typename T>
+void ArraySeq<T>::reserve(int n)
+{
+  if (n > capacity)
+  {
+    reallocate(n);
+  }
+}
+
+template <typename T>
+void ArraySeq<T>::shrink_to_fit()
+{
+  if (capacity > count)
+  {
+    reallocate(count);
+  }
+}
+
+template <typename T>
+int ArraySeq<T>::storage_capacity() const
+{
+  return capacity;
+}
+
+template <typename T>
+void ArraySeq<T>::set_growth_factor(double factor)
+{
+  if (not(factor > 1.0))
+  {
+    throw std::invalid_argument("Growth factor must be greater than 1");
+  }
+  growth_factor = factor;
 }
 
 template <typename T>
@@ -207,6 +677,7 @@ T &ArraySeq<T>::operator[](int index)
   }
   else
   {
+    sorted = false;
     return array[index];
   }
 }
@@ -226,6 +697,13 @@ const T &ArraySeq<T>::operator[](int index) const
 
 template <typename T>
 void ArraySeq<T>::insert(const T &elem, int index)
+{
+  // copy first, since elem may live in the array that is about to grow
+  insert(T(elem), index);
+}
+
+template <typename T>
+void ArraySeq<T>::insert(T &&elem, int index)
 {
   if (index < 0 or index > size())
   {
@@ -235,14 +713,22 @@ void ArraySeq<T>::insert(const T &elem, int index)
   {
     if (size() == capacity)
     {
-      resize();
+      grow(count + 1);
+    }
+    if (index == count)
+    {
+      new (array + count) T(std::move(elem));
     }
-    for (int i = size(); i > index; --i)
+    else
     {
-      array[i] = array[i - 1];
+      // the last element moves into the first unused slot, the rest
+      // shift over by one
+      new (array + count) T(std::move(array[count - 1]));
+      std::move_backward(array + index, array + count - 1, array + count);
+      array[index] = std::move(elem);
     }
-    array[index] = elem;
     count++;
+    sorted = false;
   }
 }
 
@@ -255,10 +741,8 @@ void ArraySeq<T>::erase(int index)
   }
   else
   {
-    for (int i = index; i < count - 1; ++i)
-    {
-      array[i] = array[i + 1];
-    }
+    std::move(array + index + 1, array + count, array + index);
+    array[count - 1].~T();
     count--;
   }
 }
@@ -266,6 +750,15 @@ void ArraySeq<T>::erase(int index)
 template <typename T>
 bool ArraySeq<T>::contains(const T &elem) const
 {
+  if (sorted)
+  {
+    int i = lower_bound(elem);
+    return i < count and array[i] == elem;
+  }
+  if constexpr (has_simd_find<T>::value)
+  {
+    return simd_find(array, count, elem) >= 0;
+  }
   for (int i = 0; i < count; ++i)
   {
     if (array[i] == elem)
@@ -277,160 +770,2779 @@ bool ArraySeq<T>::contains(const T &elem) const
 }
 
 template <typename T>
-void ArraySeq<T>::resize()
+bool ArraySeq<T>::is_sorted() const
+{
+  return sorted;
+}
+
+template <typename T>
+bool ArraySeq<T>::verify_sorted()
 {
-  if (capacity == 0)
+  sorted = true;
+  for (int i = 1; i < count and sorted; ++i)
   {
-    capacity = capacity + 1;
+    sorted = not(array[i] < array[i - 1]);
   }
-  else
+  return sorted;
+}
+
+template <typename T>
+int ArraySeq<T>::lower_bound(const T &elem) const
+{
+  if (not sorted)
   {
-    capacity = capacity * 2;
+    throw std::logic_error("Sequence not sorted");
   }
-
-  T *new_array = nullptr;
-  new_array = new T[capacity];
-
-  for (int i = 0; i < count; ++i)
+  int lo = 0, len = count;
+  while (len > 0)
   {
-    new_array[i] = array[i];
+    int half = len / 2;
+    if (array[lo + half] < elem)
+    {
+      lo = lo + half + 1;
+      len = len - half - 1;
+    }
+    else
+    {
+      len = half;
+    }
   }
-  delete[] array;
-  array = new_array;
+  return lo;
 }
 
-// Helper Functions
 template <typename T>
-void ArraySeq<T>::sort()
+int ArraySeq<T>::upper_bound(const T &elem) const
 {
-  quick_sort_random();
+  if (not sorted)
+  {
+    throw std::logic_error("Sequence not sorted");
+  }
+  int lo = 0, len = count;
+  while (len > 0)
+  {
+    int half = len / 2;
+    if (not(elem < array[lo + half]))
+    {
+      lo = lo + half + 1;
+      len = len - half - 1;
+    }
+    else
+    {
+      len = half;
+    }
+  }
+  return lo;
 }
 
 template <typename T>
-void ArraySeq<T>::merge_sort()
+std::pair<int, int> ArraySeq<T>::equal_range(const T &elem) const
 {
-  merge_sort(0, size() - 1);
+  return std::pair<int, int>(lower_bound(elem), upper_bound(elem));
 }
 
 template <typename T>
-void ArraySeq<T>::quick_sort()
+template <typename Compare, typename Project>
+void ArraySeq<T>::mark_sorted()
 {
-  quick_sort(0, size() - 1);
+  sorted = is_natural_order<Compare, T>::value and std::is_same<Project, Identity>::value;
 }
 
 template <typename T>
-void ArraySeq<T>::quick_sort_random()
+void ArraySeq<T>::grow(int min_capacity)
 {
-  std::srand(seed);
-  quick_sort_random(0, size() - 1);
+  double grown = capacity * growth_factor;
+  int new_capacity = grown < INT_MAX ? static_cast<int>(grown) : INT_MAX;
+  if (new_capacity < MIN_CAPACITY)
+  {
+    new_capacity = MIN_CAPACITY;
+  }
+  if (new_capacity < min_capacity)
+  {
+    new_capacity = min_capacity;
+  }
+  reallocate(new_capacity);
 }
 
 template <typename T>
-void ArraySeq<T>::merge_sort(int start, int end)
+void ArraySeq<T>::reallocate(int new_capacity)
 {
-  int mid = 0, first = 0, second = 0, i = 0;
-  if (start < end)
+  if constexpr (RELOCATE_BY_REALLOC)
   {
-    // Split Step
-    mid = (start + end) / 2;
-    merge_sort(start, mid);
-    merge_sort(mid + 1, end);
-
-    // Merge Step
-    T *temp = new T[(end - start) + 1];
-    first = start;
-    second = mid + 1;
-    i = 0;
-    while (first <= mid and second <= end)
+    if (new_capacity == 0)
     {
-      if (array[first] < array[second]) // '<=' ??
-      {
-        temp[i++] = array[first++];
-      }
-      else
-      {
-        temp[i++] = array[second++];
-      }
+      std::free(array);
+      array = nullptr;
     }
-    while (first <= mid)
+    else
     {
-      temp[i++] = array[first++];
+      void *moved = std::realloc(array, sizeof(T) * static_cast<size_t>(new_capacity));
+      if (moved == nullptr)
+      {
+        throw std::bad_alloc();
+      }
+      array = static_cast<T *>(moved);
     }
-    while (second <= end)
+  }
+  else
+  {
+    T *new_array = allocate(new_capacity);
+    std::uninitialized_move(array, array + count, new_array);
+    std::destroy(array, array + count);
+    deallocate(array, capacity);
+    array = new_array;
+  }
+  capacity = new_capacity;
+}
+
+template <typename T>
+T *ArraySeq<T>::allocate(int n)
+{
+  if (n == 0)
+  {
+    return nullptr;
+  }
+  if constexpr (RELOCATE_BY_REALLOC)
+  {
+    void *storage = std::malloc(sizeof(T) * static_cast<size_t>(n));
+    if (storage == nullptr)
     {
-      temp[i++] = array[second++];
+      throw std::bad_alloc();
     }
-    for (int j = 0; j <= (end - start); ++j)
+    return static_cast<T *>(storage);
+  }
+  else
+  {
+    return std::allocator<T>().allocate(n);
+  }
+}
+
+template <typename T>
+ArraySeq<T>::Scratch::Scratch()
+{
+}
+
+template <typename T>
+ArraySeq<T>::Scratch::Scratch(int n, T *donor, int donor_count)
+{
+  reset(n, donor, donor_count);
+}
+
+template <typename T>
+ArraySeq<T>::Scratch::~Scratch()
+{
+  std::destroy(slots, slots + live);
+  deallocate(slots, slot_capacity);
+}
+
+template <typename T>
+void ArraySeq<T>::Scratch::reset(int n, T *donor, int donor_count)
+{
+  std::destroy(slots, slots + live);
+  deallocate(slots, slot_capacity);
+  slots = nullptr;
+  slot_capacity = 0;
+  live = 0;
+
+  slots = allocate(n);
+  slot_capacity = n;
+  if constexpr (std::is_trivial<T>::value)
+  {
+    live = n;
+  }
+  else
+  {
+    // live is kept current so a throwing move leaves nothing behind
+    for (int i = 0; i < n and donor_count > 0; ++i)
     {
-      array[start + j] = temp[j];
+      T &from = donor[i % donor_count];
+      new (slots + i) T(std::move(from));
+      live = i + 1;
+      from = std::move(slots[i]);
     }
-    delete[] temp;
   }
 }
 
 template <typename T>
-void ArraySeq<T>::quick_sort(int start, int end)
+T *ArraySeq<T>::Scratch::get() const
 {
-  int end_p1 = 0;
-  T temp, pivot_val;
-  if (start < end)
+  return slots;
+}
+
+template <typename T>
+void ArraySeq<T>::deallocate(T *storage, int n)
+{
+  if (storage == nullptr)
   {
-    pivot_val = array[start];
-    end_p1 = start;
+    return;
+  }
+  if constexpr (RELOCATE_BY_REALLOC)
+  {
+    std::free(storage);
+  }
+  else
+  {
+    std::allocator<T>().deallocate(storage, n);
+  }
+}
 
-    for (int i = start + 1; i <= end; ++i)
+// Helper Functions
+template <typename T>
+void ArraySeq<T>::sort()
+{
+  sort(std::less<>());
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::sort(Compare comp, Project proj)
+{
+  if (sorted and is_natural_order<Compare, T>::value and
+      std::is_same<Project, Identity>::value)
+  {
+    return;
+  }
+  typedef sort_key_t<T, Project> Key;
+  if constexpr (is_natural_order<Compare, Key>::value and
+                std::is_integral<Key>::value and not std::is_same<Key, bool>::value)
+  {
+    if (size() >= RADIX_SORT_CUTOFF)
     {
-      if (array[i] < pivot_val)
-      {
-        end_p1 = end_p1 + 1;
-        temp = array[i];
-        array[i] = array[end_p1];
-        array[end_p1] = temp;
-      }
+      radix_sort(proj);
+      return;
     }
-
-    temp = array[start];
-    array[start] = array[end_p1];
-    array[end_p1] = temp;
-
-    quick_sort(start, end_p1 - 1);
-    quick_sort(end_p1 + 1, end);
   }
+  intro_sort(comp, proj);
 }
 
 template <typename T>
-void ArraySeq<T>::quick_sort_random(int start, int end)
+template <typename Compare, typename Project>
+ArraySeq<int> ArraySeq<T>::argsort(Compare comp, Project proj) const
 {
-  int end_p1 = 0, randIdx = 0;
-  T temp, pivot_val;
-  if (start < end)
+  ArraySeq<int> order;
+  int n = size();
+  if (n == 0)
   {
-    randIdx = start + rand() % (end - start);
+    return order;
+  }
+  order.reserve(n);
+  for (int i = 0; i < n; ++i)
+  {
+    new (order.array + i) int(i);
+  }
+  order.count = n;
+  typedef sort_key_t<T, Project> Key;
+  if constexpr (std::is_arithmetic<Key>::value)
+  {
+    // small keys: copy (key, index) pairs out so the sort streams
+    // through them instead of chasing every index back into the
+    // elements
+    typedef std::pair<Key, int> KeyIndex;
+    ArraySeq<KeyIndex> keyed;
+    keyed.reserve(n);
+    for (int i = 0; i < n; ++i)
+    {
+      new (keyed.array + i) KeyIndex(std::invoke(proj, array[i]), i);
+    }
+    keyed.count = n;
+    if constexpr (is_natural_order<Compare, Key>::value and
+                  std::is_integral<Key>::value and not std::is_same<Key, bool>::value)
+    {
+      keyed.radix_sort(&KeyIndex::first);
+    }
+    else
+    {
+      keyed.buffered_merge_sort(comp, &KeyIndex::first);
+    }
+    for (int i = 0; i < n; ++i)
+    {
+      order.array[i] = keyed.array[i].second;
+    }
+  }
+  else
+  {
+    // sort the indexes by the keys of the elements they refer to
+    const T *elems = array;
+    auto index_key = [elems, &proj](int i) -> decltype(auto) {
+      return std::invoke(proj, elems[i]);
+    };
+    order.buffered_merge_sort(comp, index_key);
+  }
+  // the indexes were written in place, so the sorted flag is whatever
+  // the identity permutation left; set it from the result instead
+  order.verify_sorted();
+  return order;
+}
 
-    temp = array[start];
-    array[start] = array[randIdx];
-    array[randIdx] = temp;
-    pivot_val = array[start];
-    end_p1 = start;
+template <typename T>
+void ArraySeq<T>::apply_permutation(const ArraySeq<int> &perm)
+{
+  int n = size();
+  if (perm.size() != n)
+  {
+    throw std::invalid_argument("Permutation size mismatch");
+  }
+  const int *from = perm.array;
 
-    for (int i = start + 1; i <= end; ++i)
+  // placed[i] is set once position i holds its final element; first
+  // used to check that every index appears exactly once
+  std::vector<bool> placed(n, false);
+  for (int i = 0; i < n; ++i)
+  {
+    if (from[i] < 0 or from[i] >= n or placed[from[i]])
     {
-      if (array[i] < pivot_val)
-      {
-        end_p1 = end_p1 + 1;
-        temp = array[i];
-        array[i] = array[end_p1];
-        array[end_p1] = temp;
-      }
+      throw std::invalid_argument("Invalid permutation");
     }
+    placed[from[i]] = true;
+  }
+  placed.assign(n, false);
+  sorted = false;
 
-    temp = array[start];
-    array[start] = array[end_p1];
-    array[end_p1] = temp;
+  for (int i = 0; i < n; ++i)
+  {
+    if (placed[i] or from[i] == i)
+    {
+      continue;
+    }
+    // walk the cycle through i, pulling each element into the hole
+    // left by the previous one
+    T hold = std::move(array[i]);
+    int hole = i;
+    while (from[hole] != i)
+    {
+      array[hole] = std::move(array[from[hole]]);
+      placed[hole] = true;
+      hole = from[hole];
+    }
+    array[hole] = std::move(hold);
+    placed[hole] = true;
+  }
+}
 
-    quick_sort_random(start, end_p1 - 1);
-    quick_sort_random(end_p1 + 1, end);
+template <typename T>
+template <typename Compare, typename Project>
+T &ArraySeq<T>::select(int k, Compare comp, Project proj)
+{
+  if (k < 0 or k >= size())
+  {
+    throw std::out_of_range("Invalid Index");
+  }
+  KeyLess<Compare, Project> less(comp, proj);
+  int depth_limit = 0;
+  for (int n = size(); n > 1; n = n / 2)
+  {
+    depth_limit += 2;
+  }
+  std::srand(seed);
+  select(0, size() - 1, k, depth_limit, less);
+  sorted = false;
+  return array[k];
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::partial_sort(int k, Compare comp, Project proj)
+{
+  if (k < 0 or k > size())
+  {
+    throw std::out_of_range("Invalid Index");
+  }
+  if (k == 0)
+  {
+    return;
+  }
+  // everything before the k-th smallest is no larger than it, so
+  // only that prefix still needs sorting
+  select(k - 1, comp, proj);
+  KeyLess<Compare, Project> less(comp, proj);
+  int depth_limit = 0;
+  for (int n = k - 1; n > 1; n = n / 2)
+  {
+    depth_limit += 2;
+  }
+  intro_sort(0, k - 2, depth_limit, less);
+  if (k == size())
+  {
+    mark_sorted<Compare, Project>();
+  }
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+LinkedSeq<T> ArraySeq<T>::top_k(int k, Compare comp, Project proj) const
+{
+  if (k < 0)
+  {
+    throw std::out_of_range("Invalid Index");
+  }
+  KeyLess<Compare, Project> less(comp, proj);
+  int n = size();
+  k = std::min(k, n);
+  LinkedSeq<T> result;
+  if (k == 0)
+  {
+    return result;
+  }
+
+  // max-heap of the k smallest seen so far, largest at the root
+  ArraySeq<T> heap;
+  heap.reserve(k);
+  std::uninitialized_copy(array, array + k, heap.array);
+  heap.count = k;
+  for (int root = k / 2 - 1; root >= 0; --root)
+  {
+    heap.sift_down(0, root, k, less);
+  }
+  for (int i = k; i < n; ++i)
+  {
+    if (less(array[i], heap.array[0]))
+    {
+      heap.array[0] = array[i];
+      heap.sift_down(0, 0, k, less);
+    }
+  }
+
+  // pop largest first, so each goes on the front of the list
+  for (int last = k - 1; last >= 0; --last)
+  {
+    result.insert(std::move(heap.array[0]), 0);
+    if (last > 0)
+    {
+      heap.array[0] = std::move(heap.array[last]);
+      heap.sift_down(0, 0, last, less);
+    }
+  }
+  return result;
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::merge_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  merge_sort(0, size() - 1, less);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::quick_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  quick_sort(0, size() - 1, less);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::quick_sort_random(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  std::srand(seed);
+  quick_sort_random(0, size() - 1, less);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::intro_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  int depth_limit = 0;
+  for (int n = size(); n > 1; n = n / 2)
+  {
+    depth_limit += 2;
+  }
+  intro_sort(0, size() - 1, depth_limit, less);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::block_quick_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  int bad_allowed = 0;
+  for (int n = size(); n > 1; n = n / 2)
+  {
+    ++bad_allowed;
+  }
+  block_quick_sort(0, size() - 1, bad_allowed, true, less);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::buffered_merge_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  if (size() > 1)
+  {
+    Scratch buffer(size(), array, size());
+    buffered_merge_sort(buffer.get(), 0, size() - 1, false, less);
+  }
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::buffered_merge_sort(T *scratch, int scratch_size, Compare comp,
+                                      Project proj)
+{
+  if (scratch == nullptr or scratch_size < size())
+  {
+    throw std::invalid_argument("Scratch buffer too small");
+  }
+  KeyLess<Compare, Project> less(comp, proj);
+  buffered_merge_sort(scratch, 0, size() - 1, false, less);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::bottom_up_merge_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  int n = size();
+  if (n <= 1)
+  {
+    mark_sorted<Compare, Project>();
+    return;
+  }
+  // counts are kept as lengths so nothing overflows near INT_MAX
+  for (int lo = 0; lo < n;)
+  {
+    int hi = n - lo > INSERTION_SORT_CUTOFF ? lo + INSERTION_SORT_CUTOFF - 1 : n - 1;
+    insertion_sort(lo, hi, less);
+    lo = hi + 1;
+  }
+
+  Scratch buffer(n, array, n);
+  T *src = array;
+  T *dst = buffer.get();
+  for (int width = INSERTION_SORT_CUTOFF; width < n;
+       width = width <= n / 2 ? 2 * width : n)
+  {
+    for (int lo = 0; lo < n;)
+    {
+      int left_len = n - lo < width ? n - lo : width;
+      int right_len = n - lo - left_len < width ? n - lo - left_len : width;
+      merge_move(src, lo, lo + left_len - 1, lo + left_len + right_len - 1, dst,
+                 less);
+      lo = lo + left_len + right_len;
+    }
+    std::swap(src, dst);
+  }
+  if (src != array)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      array[i] = std::move(src[i]);
+    }
+  }
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::tim_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  int lo = 0;
+  int remaining = size();
+  if (remaining < 2)
+  {
+    mark_sorted<Compare, Project>();
+    return;
+  }
+  if (remaining < TIM_MIN_MERGE)
+  {
+    binary_insertion_sort(0, remaining, count_run(0, remaining, less), less);
+    mark_sorted<Compare, Project>();
+    return;
+  }
+
+  // minimum run length: n divided by a power of two, rounded up so
+  // the final merges stay balanced
+  int min_run = 0, bits = 0;
+  for (min_run = remaining; min_run >= TIM_MIN_MERGE; min_run = min_run / 2)
+  {
+    bits = bits | (min_run & 1);
+  }
+  min_run += bits;
+
+  TimState state;
+  while (remaining != 0)
+  {
+    int run_len = count_run(lo, lo + remaining, less);
+    if (run_len < min_run)
+    {
+      int force = remaining <= min_run ? remaining : min_run;
+      binary_insertion_sort(lo, lo + force, lo + run_len, less);
+      run_len = force;
+    }
+    state.run_base[state.runs] = lo;
+    state.run_len[state.runs] = run_len;
+    ++state.runs;
+    tim_merge_collapse(state, less);
+    lo += run_len;
+    remaining -= run_len;
+  }
+
+  // merge whatever is left on the stack
+  while (state.runs > 1)
+  {
+    int n = state.runs - 2;
+    if (n > 0 and state.run_len[n - 1] < state.run_len[n + 1])
+    {
+      --n;
+    }
+    tim_merge_at(state, n, less);
+  }
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Project>
+void ArraySeq<T>::radix_sort(Project proj)
+{
+  typedef sort_key_t<T, Project> Value;
+  static_assert(std::is_integral<Value>::value and not std::is_same<Value, bool>::value,
+                "radix_sort() requires an integral key type");
+  typedef typename std::make_unsigned<Value>::type Key;
+  const int passes = sizeof(Value);
+  const Key sign_bit =
+      std::is_signed<Value>::value ? Key(Key(1) << (8 * sizeof(Value) - 1)) : Key(0);
+
+  int n = size();
+  if (n <= 1)
+  {
+    mark_sorted<std::less<>, Project>();
+    return;
+  }
+
+  // histogram of every digit position in one pass over the data
+  int counts[sizeof(Value)][256] = {};
+  for (int i = 0; i < n; ++i)
+  {
+    Key key = static_cast<Key>(std::invoke(proj, array[i])) ^ sign_bit;
+    for (int p = 0; p < passes; ++p)
+    {
+      ++counts[p][(key >> (8 * p)) & 0xff];
+    }
+  }
+
+  Scratch buffer(n, array, n);
+  T *src = array;
+  T *dst = buffer.get();
+  for (int p = 0; p < passes; ++p)
+  {
+    // nothing to do if every element has the same digit here
+    Key first_key = static_cast<Key>(std::invoke(proj, src[0])) ^ sign_bit;
+    if (counts[p][(first_key >> (8 * p)) & 0xff] == n)
+    {
+      continue;
+    }
+
+    int offsets[256];
+    int total = 0;
+    for (int d = 0; d < 256; ++d)
+    {
+      offsets[d] = total;
+      total += counts[p][d];
+    }
+    for (int i = 0; i < n; ++i)
+    {
+      Key key = static_cast<Key>(std::invoke(proj, src[i])) ^ sign_bit;
+      dst[offsets[(key >> (8 * p)) & 0xff]++] = std::move(src[i]);
+    }
+    std::swap(src, dst);
+  }
+  if (src != array)
+  {
+    std::move(src, src + n, array);
+  }
+  mark_sorted<std::less<>, Project>();
+}
+
+template <typename T>
+template <typename Project>
+void ArraySeq<T>::parallel_radix_sort(int threads, Project proj)
+{
+  typedef sort_key_t<T, Project> Value;
+  static_assert(std::is_integral<Value>::value and not std::is_same<Value, bool>::value,
+                "parallel_radix_sort() requires an integral key type");
+  typedef typename std::make_unsigned<Value>::type Key;
+  const int passes = sizeof(Value);
+  const Key sign_bit =
+      std::is_signed<Value>::value ? Key(Key(1) << (8 * sizeof(Value) - 1)) : Key(0);
+
+  int n = size();
+  threads = thread_count(threads);
+  if (threads > n / PARALLEL_RADIX_CUTOFF)
+  {
+    threads = n / PARALLEL_RADIX_CUTOFF;
+  }
+  if (threads <= 1)
+  {
+    radix_sort(proj);
+    return;
+  }
+
+  Scratch buffer(n, array, n);
+  T *src = array;
+  T *dst = buffer.get();
+  std::unique_ptr<int[][256]> counts(new int[threads][256]);
+  Scratch staging(threads * 256 * RADIX_STAGE_SIZE, array, n);
+  T *stage = staging.get();
+
+  for (int p = 0; p < passes; ++p)
+  {
+    const int shift = 8 * p;
+
+    // per-thread histograms of this digit over equal slices
+    run_threads(threads, [&](int t) {
+      long long lo = (long long)n * t / threads;
+      long long hi = (long long)n * (t + 1) / threads;
+      for (int d = 0; d < 256; ++d)
+      {
+        counts[t][d] = 0;
+      }
+      for (long long i = lo; i < hi; ++i)
+      {
+        Key key = static_cast<Key>(std::invoke(proj, src[i])) ^ sign_bit;
+        ++counts[t][(key >> shift) & 0xff];
+      }
+    });
+
+    // global prefix sum: thread t's digit d goes after every smaller
+    // digit and after digit d from earlier slices, which keeps it
+    // stable
+    int total = 0;
+    bool single_digit = false;
+    for (int d = 0; d < 256; ++d)
+    {
+      int digit_total = 0;
+      for (int t = 0; t < threads; ++t)
+      {
+        int count = counts[t][d];
+        counts[t][d] = total + digit_total;
+        digit_total += count;
+      }
+      single_digit = single_digit or digit_total == n;
+      total += digit_total;
+    }
+    if (single_digit)
+    {
+      continue;
+    }
+
+    // scatter through per-digit staging buffers
+    run_threads(threads, [&](int t) {
+      long long lo = (long long)n * t / threads;
+      long long hi = (long long)n * (t + 1) / threads;
+      int *offsets = counts[t];
+      T *my_stage = stage + (long long)t * 256 * RADIX_STAGE_SIZE;
+      unsigned char filled[256] = {};
+      for (long long i = lo; i < hi; ++i)
+      {
+        Key key = static_cast<Key>(std::invoke(proj, src[i])) ^ sign_bit;
+        int d = (key >> shift) & 0xff;
+        T *slot = my_stage + d * RADIX_STAGE_SIZE;
+        slot[filled[d]++] = std::move(src[i]);
+        if (filled[d] == RADIX_STAGE_SIZE)
+        {
+          std::move(slot, slot + RADIX_STAGE_SIZE, dst + offsets[d]);
+          offsets[d] += RADIX_STAGE_SIZE;
+          filled[d] = 0;
+        }
+      }
+      for (int d = 0; d < 256; ++d)
+      {
+        T *slot = my_stage + d * RADIX_STAGE_SIZE;
+        std::move(slot, slot + filled[d], dst + offsets[d]);
+      }
+    });
+    std::swap(src, dst);
+  }
+
+  if (src != array)
+  {
+    run_threads(threads, [&](int t) {
+      long long lo = (long long)n * t / threads;
+      long long hi = (long long)n * (t + 1) / threads;
+      std::move(src + lo, src + hi, array + lo);
+    });
+  }
+  mark_sorted<std::less<>, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::parallel_quick_sort(int threads, Compare comp, Project proj)
+{
+  threads = thread_count(threads);
+  int n = size();
+  if (threads <= 1 or n <= PARALLEL_SORT_CUTOFF)
+  {
+    block_quick_sort(comp, proj);
+    return;
+  }
+
+  int depth_limit = 0;
+  for (int len = n; len > 1; len = len / 2)
+  {
+    depth_limit += 2;
+  }
+  KeyLess<Compare, Project> less(comp, proj);
+  auto root = [this, n, depth_limit, &less](WorkStealingPool &pool, int worker) {
+    parallel_quick_sort(pool, worker, 0, n - 1, depth_limit, less);
+  };
+  WorkStealingPool::run(threads, root);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::parallel_quick_sort(WorkStealingPool &pool, int worker,
+                                      int start, int end, int depth_limit,
+                                      const Less &less)
+{
+  while (end - start + 1 > PARALLEL_SORT_CUTOFF and depth_limit > 0)
+  {
+    --depth_limit;
+    int len = end - start + 1;
+    int half = len / 2;
+    int left_end = 0, right_start = 0;
+
+    if (len >= PARALLEL_PARTITION_CUTOFF and pool.thread_count() > 1)
+    {
+      // pseudo-median of nine, copied out since the partition moves
+      // elements around
+      sort3(start, start + half, end, less);
+      sort3(start + 1, start + half - 1, end - 1, less);
+      sort3(start + 2, start + half + 1, end - 2, less);
+      sort3(start + half - 1, start + half, start + half + 1, less);
+      T pivot_val = array[start + half];
+
+      int mid = parallel_partition(pool, worker, start, end, pivot_val, false, less);
+      if (mid == start)
+      {
+        // nothing is smaller than the pivot: split off the keys equal
+        // to it, which are already in their final place
+        start = parallel_partition(pool, worker, start, end, pivot_val, true, less);
+        continue;
+      }
+      left_end = mid - 1;
+      right_start = mid;
+    }
+    else
+    {
+      sort3(start + half, start, end, less);
+      bool already_partitioned = false;
+      int pivot_idx = block_partition(start, end, already_partitioned, less);
+      left_end = pivot_idx - 1;
+      right_start = pivot_idx + 1;
+    }
+
+    // leave the left side for another worker, keep the right
+    int lo = start;
+    int hi = left_end;
+    int depth = depth_limit;
+    pool.spawn(worker, [this, lo, hi, depth, &less](WorkStealingPool &p, int w) {
+      parallel_quick_sort(p, w, lo, hi, depth, less);
+    });
+    start = right_start;
+  }
+
+  // small or too many bad splits: finish serially, never looking at
+  // elements outside the range since other workers may own them
+  if (start < end)
+  {
+    int bad_allowed = 0;
+    for (int len = end - start + 1; len > 1; len = len / 2)
+    {
+      ++bad_allowed;
+    }
+    block_quick_sort(start, end, bad_allowed, true, less);
+  }
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::parallel_partition(WorkStealingPool &pool, int worker,
+                                    int start, int end, const T &pivot_val,
+                                    bool equal_left, const Less &less)
+{
+  // partitions array[start..end] so elements less than the pivot (or
+  // not greater, if equal_left) come first, and returns the index of
+  // the first element of the right side
+  int len = end - start + 1;
+  int chunks = len / PARTITION_CHUNK_SIZE;
+  if (chunks > pool.thread_count())
+  {
+    chunks = pool.thread_count();
+  }
+  if (chunks < 2)
+  {
+    return start + partition_chunk(start, end + 1, pivot_val, equal_left, less);
+  }
+
+  // step 1: every chunk partitions itself
+  std::vector<int> chunk_lo(chunks + 1);
+  std::vector<int> left_count(chunks);
+  for (int c = 0; c <= chunks; ++c)
+  {
+    chunk_lo[c] = start + (int)((long long)len * c / chunks);
+  }
+  std::atomic<int> remaining(chunks - 1);
+  for (int c = 1; c < chunks; ++c)
+  {
+    pool.spawn(worker, [&, c](WorkStealingPool &, int) {
+      left_count[c] = partition_chunk(chunk_lo[c], chunk_lo[c + 1], pivot_val,
+                                      equal_left, less);
+      remaining.fetch_sub(1);
+    });
+  }
+  left_count[0] = partition_chunk(chunk_lo[0], chunk_lo[1], pivot_val, equal_left,
+                                  less);
+  pool.help_until_zero(worker, remaining);
+
+  // step 2: find the right-side elements that landed left of the
+  // split and the left-side elements that landed right of it; there
+  // are the same number of each
+  int mid = start;
+  for (int c = 0; c < chunks; ++c)
+  {
+    mid += left_count[c];
+  }
+  std::vector<std::pair<int, int>> wrong_left;  // [lo, hi) ranges
+  std::vector<std::pair<int, int>> wrong_right; // [lo, hi) ranges
+  long long misplaced = 0;
+  for (int c = 0; c < chunks; ++c)
+  {
+    int split = chunk_lo[c] + left_count[c];
+    int lo = split > chunk_lo[c] ? split : chunk_lo[c];
+    int hi = chunk_lo[c + 1] < mid ? chunk_lo[c + 1] : mid;
+    if (lo < hi)
+    {
+      wrong_left.push_back(std::make_pair(lo, hi));
+      misplaced += hi - lo;
+    }
+    lo = chunk_lo[c] > mid ? chunk_lo[c] : mid;
+    hi = split;
+    if (lo < hi)
+    {
+      wrong_right.push_back(std::make_pair(lo, hi));
+    }
+  }
+
+  // step 3: swap the misplaced pairs, split evenly across chunks
+  auto swap_pairs = [&](int c) {
+    long long first = misplaced * c / chunks;
+    long long count = misplaced * (c + 1) / chunks - first;
+    if (count == 0)
+    {
+      return;
+    }
+    int l = 0, r = 0;
+    long long l_skip = first, r_skip = first;
+    while (l_skip >= wrong_left[l].second - wrong_left[l].first)
+    {
+      l_skip -= wrong_left[l].second - wrong_left[l].first;
+      ++l;
+    }
+    while (r_skip >= wrong_right[r].second - wrong_right[r].first)
+    {
+      r_skip -= wrong_right[r].second - wrong_right[r].first;
+      ++r;
+    }
+    int i = wrong_left[l].first + (int)l_skip;
+    int j = wrong_right[r].first + (int)r_skip;
+    for (long long k = 0; k < count; ++k)
+    {
+      if (i == wrong_left[l].second)
+      {
+        ++l;
+        i = wrong_left[l].first;
+      }
+      if (j == wrong_right[r].second)
+      {
+        ++r;
+        j = wrong_right[r].first;
+      }
+      std::swap(array[i++], array[j++]);
+    }
+  };
+  if (misplaced > 0)
+  {
+    remaining.store(chunks - 1);
+    for (int c = 1; c < chunks; ++c)
+    {
+      pool.spawn(worker, [&, c](WorkStealingPool &, int) {
+        swap_pairs(c);
+        remaining.fetch_sub(1);
+      });
+    }
+    swap_pairs(0);
+    pool.help_until_zero(worker, remaining);
+  }
+  return mid;
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::parallel_merge_sort(int threads, Compare comp, Project proj)
+{
+  int n = size();
+  threads = thread_count(threads);
+  if (threads > n / PARALLEL_MERGE_CUTOFF)
+  {
+    threads = n / PARALLEL_MERGE_CUTOFF;
+  }
+  if (threads <= 1)
+  {
+    buffered_merge_sort(comp, proj);
+    return;
+  }
+
+  KeyLess<Compare, Project> less(comp, proj);
+  Scratch scratch(n, array, n);
+  T *buffer = scratch.get();
+  int runs = threads;
+  std::unique_ptr<int[]> bounds(new int[runs + 1]);
+  for (int r = 0; r <= runs; ++r)
+  {
+    bounds[r] = (int)((long long)n * r / runs);
+  }
+
+  // every thread sorts its own slice in place
+  run_threads(threads, [&](int t) {
+    buffered_merge_sort(buffer, bounds[t], bounds[t + 1] - 1, false, less);
+  });
+
+  // merge pairs of runs until one is left; thread t always produces
+  // output positions [n*t/threads, n*(t+1)/threads) of the round
+  T *src = array;
+  T *dst = buffer;
+  while (runs > 1)
+  {
+    run_threads(threads, [&](int t) {
+      int out_lo = (int)((long long)n * t / threads);
+      int out_hi = (int)((long long)n * (t + 1) / threads);
+      for (int r = 0; r < runs and out_lo < out_hi; r += 2)
+      {
+        int first = bounds[r];
+        int second = bounds[r + 1];
+        int second_end = r + 2 <= runs ? bounds[r + 2] : second;
+        if (second_end <= out_lo)
+        {
+          continue;
+        }
+        int k_lo = out_lo - first;
+        int k_hi = (out_hi < second_end ? out_hi : second_end) - first;
+        int i_lo = co_rank(k_lo, src, first, second - first, second,
+                           second_end - second, less);
+        int i_hi = co_rank(k_hi, src, first, second - first, second,
+                           second_end - second, less);
+        merge_move_ranges(src, first + i_lo, first + i_hi, second + k_lo - i_lo,
+                          second + k_hi - i_hi, dst, out_lo, less);
+        out_lo = first + k_hi;
+      }
+    });
+
+    int merged = 0;
+    for (int r = 0; r < runs; r += 2)
+    {
+      bounds[merged++] = bounds[r];
+    }
+    bounds[merged] = n;
+    runs = merged;
+    std::swap(src, dst);
+  }
+
+  if (src != array)
+  {
+    run_threads(threads, [&](int t) {
+      long long lo = (long long)n * t / threads;
+      long long hi = (long long)n * (t + 1) / threads;
+      std::move(src + lo, src + hi, array + lo);
+    });
+  }
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::parallel_sample_sort(int threads, Compare comp, Project proj)
+{
+  int n = size();
+  threads = thread_count(threads);
+  if (threads > n / PARALLEL_SAMPLE_CUTOFF)
+  {
+    threads = n / PARALLEL_SAMPLE_CUTOFF;
+  }
+  if (threads <= 1)
+  {
+    block_quick_sort(comp, proj);
+    return;
+  }
+
+  KeyLess<Compare, Project> less(comp, proj);
+  int levels = 1;
+  while ((1 << levels) < 2 * threads)
+  {
+    ++levels;
+  }
+  const int buckets = 1 << levels;
+
+  // sort a pseudo-random oversample and take evenly spaced splitters,
+  // stored as an implicit binary tree: node j has children 2j, 2j+1
+  int sample_len = buckets * SAMPLE_OVERSAMPLING;
+  Scratch samples(sample_len, array, n);
+  T *sample = samples.get();
+  unsigned int x = seed;
+  for (int i = 0; i < sample_len; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    sample[i] = array[x % n];
+  }
+  std::sort(sample, sample + sample_len, less);
+  Scratch splitters(buckets, array, n);
+  T *tree = splitters.get();
+  for (int node = 1, level_size = 1; level_size < buckets; level_size *= 2)
+  {
+    // splitter k is the k-th of buckets-1 in sorted order; level by
+    // level, node j at depth d holds splitter (2*(j - 2^d) + 1) *
+    // buckets / 2^(d+1)
+    for (int i = 0; i < level_size; ++i, ++node)
+    {
+      int k = (2 * i + 1) * (buckets / (2 * level_size));
+      tree[node] = sample[k * SAMPLE_OVERSAMPLING - 1];
+    }
+  }
+
+  // bucket b holds keys in (splitter b-1, splitter b]. If two adjacent
+  // splitters are equal, the keys equal to them would all land in one
+  // bucket with smaller keys and be sorted again, so instead every
+  // bucket b but the last is split in two: slot 2b for keys below
+  // splitter b, and slot 2b+1 for keys equal to it, already in order.
+  const T *upper = sample + SAMPLE_OVERSAMPLING - 1; // splitter b
+  bool equal_buckets = false;
+  for (int b = 1; b < buckets - 1; ++b)
+  {
+    if (not less(upper[(b - 1) * SAMPLE_OVERSAMPLING], upper[b * SAMPLE_OVERSAMPLING]))
+    {
+      equal_buckets = true;
+    }
+  }
+  const int slots = equal_buckets ? 2 * buckets : buckets;
+
+  // pass 1: classify every element and count slot sizes per thread
+  std::unique_ptr<unsigned short[]> oracle(new unsigned short[n]);
+  std::unique_ptr<int[]> counts(new int[threads * slots]());
+  run_threads(threads, [&](int t) {
+    long long lo = (long long)n * t / threads;
+    long long hi = (long long)n * (t + 1) / threads;
+    int *my_counts = counts.get() + t * slots;
+    for (long long i = lo; i < hi; ++i)
+    {
+      int j = 1;
+      for (int l = 0; l < levels; ++l)
+      {
+        j = 2 * j + less(tree[j], array[i]);
+      }
+      int b = j - buckets;
+      if (equal_buckets)
+      {
+        b = 2 * b + (b < buckets - 1 and
+                     not less(array[i], upper[b * SAMPLE_OVERSAMPLING]));
+      }
+      oracle[i] = static_cast<unsigned short>(b);
+      ++my_counts[b];
+    }
+  });
+
+  // slot b from thread t goes after all smaller slots and after slot b
+  // from earlier threads
+  std::unique_ptr<int[]> bucket_start(new int[slots + 1]);
+  int total = 0;
+  for (int b = 0; b < slots; ++b)
+  {
+    bucket_start[b] = total;
+    for (int t = 0; t < threads; ++t)
+    {
+      int count = counts[t * slots + b];
+      counts[t * slots + b] = total;
+      total += count;
+    }
+  }
+  bucket_start[slots] = n;
+
+  // pass 2: distribute into new storage of the same capacity, which
+  // then replaces the old one
+  T *buffer = allocate(capacity);
+  run_threads(threads, [&](int t) {
+    long long lo = (long long)n * t / threads;
+    long long hi = (long long)n * (t + 1) / threads;
+    int *offsets = counts.get() + t * slots;
+    for (long long i = lo; i < hi; ++i)
+    {
+      new (buffer + offsets[oracle[i]]++) T(std::move(array[i]));
+    }
+    std::destroy(array + lo, array + hi);
+  });
+  deallocate(array, capacity);
+  array = buffer;
+
+  // sort the buckets in parallel, handing them out as threads free up;
+  // equality slots are skipped
+  const int step = equal_buckets ? 2 : 1;
+  std::atomic<int> next_bucket(0);
+  run_threads(threads, [&](int) {
+    for (int b = next_bucket++; b < buckets; b = next_bucket++)
+    {
+      int lo = bucket_start[b * step];
+      int hi = bucket_start[b * step + 1] - 1;
+      if (lo < hi)
+      {
+        int bad_allowed = 0;
+        for (int len = hi - lo + 1; len > 1; len = len / 2)
+        {
+          ++bad_allowed;
+        }
+        block_quick_sort(lo, hi, bad_allowed, true, less);
+      }
+    }
+  });
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::co_rank(int k, const T *src, int first, int first_len,
+                         int second, int second_len, const Less &less)
+{
+  // number of elements the first k outputs of a stable merge of the
+  // two runs take from the first run
+  int lo = k > second_len ? k - second_len : 0;
+  int hi = k < first_len ? k : first_len;
+  while (lo < hi)
+  {
+    int i = lo + (hi - lo) / 2;
+    int j = k - i;
+    // first[i] still comes before second[j-1], so take more of first
+    if (j > 0 and not less(src[second + j - 1], src[first + i]))
+    {
+      lo = i + 1;
+    }
+    else
+    {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::partition_chunk(int lo, int hi, const T &pivot_val,
+                                 bool equal_left, const Less &less)
+{
+  // Hoare-style partition of array[lo..hi-1], returns how many
+  // elements went left
+  int i = lo, j = hi - 1;
+  while (true)
+  {
+    while (i <= j and (equal_left ? not less(pivot_val, array[i])
+                                  : less(array[i], pivot_val)))
+    {
+      ++i;
+    }
+    while (i <= j and not(equal_left ? not less(pivot_val, array[j])
+                                     : less(array[j], pivot_val)))
+    {
+      --j;
+    }
+    if (i >= j)
+    {
+      break;
+    }
+    std::swap(array[i++], array[j--]);
+  }
+  return i - lo;
+}
+
+template <typename T>
+template <typename Fn>
+void ArraySeq<T>::run_threads(int threads, Fn fn)
+{
+  std::thread *workers = new std::thread[threads - 1];
+  for (int t = 1; t < threads; ++t)
+  {
+    workers[t - 1] = std::thread(fn, t);
+  }
+  fn(0);
+  for (int t = 1; t < threads; ++t)
+  {
+    workers[t - 1].join();
+  }
+  delete[] workers;
+}
+
+template <typename T>
+int ArraySeq<T>::thread_count(int threads)
+{
+  if (threads <= 0)
+  {
+    threads = std::thread::hardware_concurrency();
+  }
+  return threads < 1 ? 1 : threads;
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::three_way_quick_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  three_way_quick_sort(0, size() - 1, less);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Compare, typename Project>
+void ArraySeq<T>::dual_pivot_quick_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  dual_pivot_quick_sort(0, size() - 1, less);
+  mark_sorted<Compare, Project>();
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::merge_sort(int start, int end, const Less &less)
+{
+  int mid = 0, first = 0, second = 0, i = 0;
+  if (start < end)
+  {
+    // Split Step
+    mid = (start + end) / 2;
+    merge_sort(start, mid, less);
+    merge_sort(mid + 1, end, less);
+
+    // Merge Step
+    Scratch scratch((end - start) + 1, array + start, (end - start) + 1);
+    T *temp = scratch.get();
+    first = start;
+    second = mid + 1;
+    i = 0;
+    while (first <= mid and second <= end)
+    {
+      if (less(array[first], array[second])) // '<=' ??
+      {
+        temp[i++] = std::move(array[first++]);
+      }
+      else
+      {
+        temp[i++] = std::move(array[second++]);
+      }
+    }
+    while (first <= mid)
+    {
+      temp[i++] = std::move(array[first++]);
+    }
+    while (second <= end)
+    {
+      temp[i++] = std::move(array[second++]);
+    }
+    for (int j = 0; j <= (end - start); ++j)
+    {
+      array[start + j] = std::move(temp[j]);
+    }
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::quick_sort(int start, int end, const Less &less)
+{
+  int end_p1 = 0;
+  if (start < end)
+  {
+    // array[start] stays put until the final swap, so the pivot can be
+    // read in place rather than copied out
+    const T &pivot_val = array[start];
+    end_p1 = start;
+
+    for (int i = start + 1; i <= end; ++i)
+    {
+      if (less(array[i], pivot_val))
+      {
+        end_p1 = end_p1 + 1;
+        std::swap(array[i], array[end_p1]);
+      }
+    }
+
+    std::swap(array[start], array[end_p1]);
+
+    quick_sort(start, end_p1 - 1, less);
+    quick_sort(end_p1 + 1, end, less);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::quick_sort_random(int start, int end, const Less &less)
+{
+  int end_p1 = 0, randIdx = 0;
+  if (start < end)
+  {
+    randIdx = start + rand() % (end - start);
+    end_p1 = partition(start, end, randIdx, less);
+
+    quick_sort_random(start, end_p1 - 1, less);
+    quick_sort_random(end_p1 + 1, end, less);
+  }
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::partition(int start, int end, int pivot_idx, const Less &less)
+{
+  // Lomuto partition around array[pivot_idx], returns the pivot's
+  // final index
+  std::swap(array[start], array[pivot_idx]);
+  const T &pivot_val = array[start];
+  int end_p1 = start;
+
+  for (int i = start + 1; i <= end; ++i)
+  {
+    if (less(array[i], pivot_val))
+    {
+      end_p1 = end_p1 + 1;
+      std::swap(array[i], array[end_p1]);
+    }
+  }
+
+  std::swap(array[start], array[end_p1]);
+  return end_p1;
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::select(int start, int end, int k, int depth_limit,
+                         const Less &less)
+{
+  while (end - start + 1 > INSERTION_SORT_CUTOFF)
+  {
+    int pivot_idx = 0;
+    if (depth_limit > 0)
+    {
+      --depth_limit;
+      pivot_idx = start + rand() % (end - start + 1);
+    }
+    else
+    {
+      pivot_idx = median_of_medians(start, end, less);
+    }
+    int mid = partition(start, end, pivot_idx, less);
+    if (mid == k)
+    {
+      return;
+    }
+    if (k < mid)
+    {
+      end = mid - 1;
+    }
+    else if (mid > start)
+    {
+      start = mid + 1;
+    }
+    else
+    {
+      // nothing is smaller than the pivot: split off the keys equal
+      // to it, which are already in their final place
+      start = start + 1 +
+              partition_chunk(start + 1, end + 1, array[start], true, less);
+      if (k < start)
+      {
+        return;
+      }
+    }
+  }
+  insertion_sort(start, end, less);
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::median_of_medians(int start, int end, const Less &less)
+{
+  // insertion sort groups of five and gather their medians at the
+  // front of the range, then select the median of those
+  int medians = 0;
+  for (int group = start; group <= end; group += 5)
+  {
+    int group_end = std::min(group + 4, end);
+    insertion_sort(group, group_end, less);
+    std::swap(array[start + medians], array[group + (group_end - group) / 2]);
+    ++medians;
+  }
+  int mid = start + (medians - 1) / 2;
+  select(start, start + medians - 1, mid, 0, less);
+  return mid;
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::intro_sort(int start, int end, int depth_limit, const Less &less)
+{
+  while (end - start + 1 > INSERTION_SORT_CUTOFF)
+  {
+    if (depth_limit == 0)
+    {
+      heap_sort(start, end, less);
+      return;
+    }
+    --depth_limit;
+
+    // median-of-three: order start, mid, end and park the pivot at
+    // start + 1 so both ends act as sentinels for the scans below
+    int mid = start + (end - start) / 2;
+    if (less(array[mid], array[start]))
+    {
+      std::swap(array[mid], array[start]);
+    }
+    if (less(array[end], array[mid]))
+    {
+      std::swap(array[end], array[mid]);
+      if (less(array[mid], array[start]))
+      {
+        std::swap(array[mid], array[start]);
+      }
+    }
+    std::swap(array[mid], array[start + 1]);
+    const T &pivot_val = array[start + 1];
+
+    // Hoare partition, stopping on equal keys to keep splits balanced
+    int i = start + 1, j = end;
+    while (true)
+    {
+      do
+      {
+        ++i;
+      } while (less(array[i], pivot_val));
+      do
+      {
+        --j;
+      } while (less(pivot_val, array[j]));
+      if (i >= j)
+      {
+        break;
+      }
+      std::swap(array[i], array[j]);
+    }
+    std::swap(array[start + 1], array[j]);
+
+    // recurse into the smaller side, loop on the larger one
+    if (j - start < end - j)
+    {
+      intro_sort(start, j - 1, depth_limit, less);
+      start = j + 1;
+    }
+    else
+    {
+      intro_sort(j + 1, end, depth_limit, less);
+      end = j - 1;
+    }
+  }
+  insertion_sort(start, end, less);
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::three_way_quick_sort(int start, int end, const Less &less)
+{
+  while (end - start + 1 > INSERTION_SORT_CUTOFF)
+  {
+    int len = end - start + 1;
+    int mid = start + len / 2;
+    if (len > NINTHER_CUTOFF)
+    {
+      int step = len / 8;
+      sort3(start, start + step, start + 2 * step, less);
+      sort3(mid - step, mid, mid + step, less);
+      sort3(end - 2 * step, end - step, end, less);
+      sort3(start + step, mid, end - step, less);
+    }
+    else
+    {
+      sort3(start, mid, end, less);
+    }
+    T pivot_val = array[mid];
+
+    // [start, lt) < pivot, [lt, i) == pivot, (gt, end] > pivot
+    int lt = start, i = start, gt = end;
+    while (i <= gt)
+    {
+      if (less(array[i], pivot_val))
+      {
+        std::swap(array[lt++], array[i++]);
+      }
+      else if (less(pivot_val, array[i]))
+      {
+        std::swap(array[i], array[gt--]);
+      }
+      else
+      {
+        ++i;
+      }
+    }
+
+    // recurse into the smaller side, loop on the larger one
+    if (lt - start < end - gt)
+    {
+      three_way_quick_sort(start, lt - 1, less);
+      start = gt + 1;
+    }
+    else
+    {
+      three_way_quick_sort(gt + 1, end, less);
+      end = lt - 1;
+    }
+  }
+  insertion_sort(start, end, less);
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::dual_pivot_quick_sort(int start, int end, const Less &less)
+{
+  while (end - start + 1 > INSERTION_SORT_CUTOFF)
+  {
+    // five evenly spaced samples around the middle, insertion sorted
+    int len = end - start + 1;
+    int seventh = len / 8 + len / 64 + 1;
+    int e[5];
+    e[2] = start + len / 2;
+    e[1] = e[2] - seventh;
+    e[0] = e[1] - seventh;
+    e[3] = e[2] + seventh;
+    e[4] = e[3] + seventh;
+    for (int i = 1; i < 5; ++i)
+    {
+      for (int j = i; j > 0 and less(array[e[j]], array[e[j - 1]]); --j)
+      {
+        std::swap(array[e[j]], array[e[j - 1]]);
+      }
+    }
+
+    // the three parts left to sort, as inclusive index ranges
+    int lo[3];
+    int hi[3];
+    if (less(array[e[1]], array[e[3]]))
+    {
+      // move the pivots out of the way to the ends of the range
+      std::swap(array[e[1]], array[start]);
+      std::swap(array[e[3]], array[end]);
+      // both pivots stay at the ends until the loop below finishes
+      const T *pivot1 = &array[start];
+      const T *pivot2 = &array[end];
+
+      // [start+1, lt) < pivot1, [lt, k) in between, (gt, end-1] > pivot2
+      int lt = start + 1, k = start + 1, gt = end - 1;
+      while (k <= gt)
+      {
+        if (less(array[k], *pivot1))
+        {
+          std::swap(array[k], array[lt++]);
+        }
+        else if (less(*pivot2, array[k]))
+        {
+          while (less(*pivot2, array[gt]) and k < gt)
+          {
+            --gt;
+          }
+          std::swap(array[k], array[gt--]);
+          if (less(array[k], *pivot1))
+          {
+            std::swap(array[k], array[lt++]);
+          }
+        }
+        ++k;
+      }
+      --lt;
+      ++gt;
+      std::swap(array[start], array[lt]);
+      std::swap(array[end], array[gt]);
+      pivot1 = &array[lt];
+      pivot2 = &array[gt];
+      lo[0] = start;
+      hi[0] = lt - 1;
+      lo[2] = gt + 1;
+      hi[2] = end;
+
+      // a middle part covering most of the range likely holds many
+      // copies of the pivots, so pull those out to its ends first
+      int mid_lo = lt + 1, mid_hi = gt - 1;
+      if (mid_lo < e[0] and e[4] < mid_hi)
+      {
+        k = mid_lo;
+        while (k <= mid_hi)
+        {
+          if (not less(*pivot1, array[k]))
+          {
+            std::swap(array[k], array[mid_lo++]);
+          }
+          else if (not less(array[k], *pivot2))
+          {
+            while (not less(array[mid_hi], *pivot2) and k < mid_hi)
+            {
+              --mid_hi;
+            }
+            std::swap(array[k], array[mid_hi--]);
+            if (not less(*pivot1, array[k]))
+            {
+              std::swap(array[k], array[mid_lo++]);
+            }
+          }
+          ++k;
+        }
+      }
+      lo[1] = mid_lo;
+      hi[1] = mid_hi;
+    }
+    else
+    {
+      // equal pivots, so partition three ways around that value
+      T pivot_val = array[e[2]];
+      int lt = start, i = start, gt = end;
+      while (i <= gt)
+      {
+        if (less(array[i], pivot_val))
+        {
+          std::swap(array[lt++], array[i++]);
+        }
+        else if (less(pivot_val, array[i]))
+        {
+          std::swap(array[i], array[gt--]);
+        }
+        else
+        {
+          ++i;
+        }
+      }
+      lo[0] = start;
+      hi[0] = lt - 1;
+      lo[1] = lt;
+      hi[1] = lt - 1;
+      lo[2] = gt + 1;
+      hi[2] = end;
+    }
+
+    // recurse into the two smaller parts, loop on the largest
+    int largest = 0;
+    for (int i = 1; i < 3; ++i)
+    {
+      if (hi[i] - lo[i] > hi[largest] - lo[largest])
+      {
+        largest = i;
+      }
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+      if (i != largest)
+      {
+        dual_pivot_quick_sort(lo[i], hi[i], less);
+      }
+    }
+    start = lo[largest];
+    end = hi[largest];
+  }
+  insertion_sort(start, end, less);
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::heap_sort(int start, int end, const Less &less)
+{
+  int len = end - start + 1;
+  for (int root = len / 2 - 1; root >= 0; --root)
+  {
+    sift_down(start, root, len, less);
+  }
+  for (int last = len - 1; last > 0; --last)
+  {
+    std::swap(array[start], array[start + last]);
+    sift_down(start, 0, last, less);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::sift_down(int start, int root, int len, const Less &less)
+{
+  T hold = std::move(array[start + root]);
+  int child = 2 * root + 1;
+  while (child < len)
+  {
+    if (child + 1 < len and less(array[start + child], array[start + child + 1]))
+    {
+      ++child;
+    }
+    if (not less(hold, array[start + child]))
+    {
+      break;
+    }
+    array[start + root] = std::move(array[start + child]);
+    root = child;
+    child = 2 * root + 1;
+  }
+  array[start + root] = std::move(hold);
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::insertion_sort(int start, int end, const Less &less)
+{
+  for (int i = start + 1; i <= end; ++i)
+  {
+    T hold = std::move(array[i]);
+    int j = i;
+    while (j > start and less(hold, array[j - 1]))
+    {
+      array[j] = std::move(array[j - 1]);
+      --j;
+    }
+    array[j] = std::move(hold);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::block_quick_sort(int start, int end, int bad_allowed,
+                                   bool leftmost, const Less &less)
+{
+  while (true)
+  {
+    int len = end - start + 1;
+    if (len <= INSERTION_SORT_CUTOFF)
+    {
+      insertion_sort(start, end, less);
+      return;
+    }
+
+    // choose the pivot and move it to start
+    int half = len / 2;
+    if (len > NINTHER_CUTOFF)
+    {
+      sort3(start, start + half, end, less);
+      sort3(start + 1, start + half - 1, end - 1, less);
+      sort3(start + 2, start + half + 1, end - 2, less);
+      sort3(start + half - 1, start + half, start + half + 1, less);
+      std::swap(array[start], array[start + half]);
+    }
+    else
+    {
+      sort3(start + half, start, end, less);
+    }
+
+    // if the pivot equals the element just left of this partition
+    // (which is <= everything in it), every element equal to the
+    // pivot can be put on the left and skipped
+    if (not leftmost and not less(array[start - 1], array[start]))
+    {
+      start = partition_left(start, end, less) + 1;
+      continue;
+    }
+
+    bool already_partitioned = false;
+    int pivot_idx = block_partition(start, end, already_partitioned, less);
+    int left_len = pivot_idx - start;
+    int right_len = end - pivot_idx;
+
+    if (left_len < len / 8 or right_len < len / 8)
+    {
+      // bad partition: give up after too many, otherwise swap some
+      // elements around to break up patterns that fool the pivot
+      if (--bad_allowed == 0)
+      {
+        heap_sort(start, end, less);
+        return;
+      }
+      if (left_len > INSERTION_SORT_CUTOFF)
+      {
+        std::swap(array[start], array[start + left_len / 4]);
+        std::swap(array[pivot_idx - 1], array[pivot_idx - left_len / 4]);
+        if (left_len > NINTHER_CUTOFF)
+        {
+          std::swap(array[start + 1], array[start + left_len / 4 + 1]);
+          std::swap(array[start + 2], array[start + left_len / 4 + 2]);
+          std::swap(array[pivot_idx - 2], array[pivot_idx - left_len / 4 - 1]);
+          std::swap(array[pivot_idx - 3], array[pivot_idx - left_len / 4 - 2]);
+        }
+      }
+      if (right_len > INSERTION_SORT_CUTOFF)
+      {
+        std::swap(array[pivot_idx + 1], array[pivot_idx + 1 + right_len / 4]);
+        std::swap(array[end], array[end + 1 - right_len / 4]);
+        if (right_len > NINTHER_CUTOFF)
+        {
+          std::swap(array[pivot_idx + 2], array[pivot_idx + 2 + right_len / 4]);
+          std::swap(array[pivot_idx + 3], array[pivot_idx + 3 + right_len / 4]);
+          std::swap(array[end - 1], array[end - right_len / 4]);
+          std::swap(array[end - 2], array[end - 1 - right_len / 4]);
+        }
+      }
+    }
+    else if (already_partitioned and
+             partial_insertion_sort(start, pivot_idx - 1, less) and
+             partial_insertion_sort(pivot_idx + 1, end, less))
+    {
+      // no swaps were needed and both sides were nearly sorted
+      return;
+    }
+
+    block_quick_sort(start, pivot_idx - 1, bad_allowed, leftmost, less);
+    start = pivot_idx + 1;
+    leftmost = false;
+  }
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::block_partition(int start, int end, bool &already_partitioned,
+                                 const Less &less)
+{
+  T pivot_val = std::move(array[start]);
+  int first = start;
+  int last = end + 1;
+
+  // skip the prefix and suffix that are already on the correct side;
+  // the median selection guarantees an element >= pivot exists
+  while (less(array[++first], pivot_val))
+  {
+  }
+  if (first - 1 == start)
+  {
+    while (first < last and not less(array[--last], pivot_val))
+    {
+    }
+  }
+  else
+  {
+    while (not less(array[--last], pivot_val))
+    {
+    }
+  }
+
+  already_partitioned = first >= last;
+  if (not already_partitioned)
+  {
+    std::swap(array[first], array[last]);
+    ++first;
+
+    // offsets of misplaced elements relative to the block bases
+    alignas(64) unsigned char offsets_l[PARTITION_BLOCK_SIZE];
+    alignas(64) unsigned char offsets_r[PARTITION_BLOCK_SIZE];
+    int base_l = first, base_r = last;
+    int num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+    while (first < last)
+    {
+      // fill whichever offset buffers are empty, splitting what is
+      // left evenly once fewer than two blocks remain
+      int unknown = last - first;
+      int left_split = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+      int right_split = num_r == 0 ? (unknown - left_split) : 0;
+      if (left_split > PARTITION_BLOCK_SIZE)
+      {
+        left_split = PARTITION_BLOCK_SIZE;
+      }
+      if (right_split > PARTITION_BLOCK_SIZE)
+      {
+        right_split = PARTITION_BLOCK_SIZE;
+      }
+
+      // branchless classification: always record the offset, only
+      // advance the count when the element is misplaced
+      for (int i = 0; i < left_split; ++i)
+      {
+        offsets_l[num_l] = static_cast<unsigned char>(i);
+        num_l += not less(array[first], pivot_val);
+        ++first;
+      }
+      for (int i = 0; i < right_split; ++i)
+      {
+        offsets_r[num_r] = static_cast<unsigned char>(i + 1);
+        num_r += less(array[--last], pivot_val);
+      }
+
+      // swap as many pairs of misplaced elements as possible, using a
+      // rotation through one temporary when counts are unequal
+      int num = num_l < num_r ? num_l : num_r;
+      if (num_l == num_r)
+      {
+        for (int i = 0; i < num; ++i)
+        {
+          std::swap(array[base_l + offsets_l[start_l + i]],
+                    array[base_r - offsets_r[start_r + i]]);
+        }
+      }
+      else if (num > 0)
+      {
+        int l = base_l + offsets_l[start_l];
+        int r = base_r - offsets_r[start_r];
+        T hold = std::move(array[l]);
+        array[l] = std::move(array[r]);
+        for (int i = 1; i < num; ++i)
+        {
+          l = base_l + offsets_l[start_l + i];
+          array[r] = std::move(array[l]);
+          r = base_r - offsets_r[start_r + i];
+          array[l] = std::move(array[r]);
+        }
+        array[r] = std::move(hold);
+      }
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0)
+      {
+        start_l = 0;
+        base_l = first;
+      }
+      if (num_r == 0)
+      {
+        start_r = 0;
+        base_r = last;
+      }
+    }
+
+    // one buffer may still hold misplaced elements; move them to the
+    // boundary
+    if (num_l > 0)
+    {
+      while (num_l--)
+      {
+        std::swap(array[base_l + offsets_l[start_l + num_l]], array[--last]);
+      }
+      first = last;
+    }
+    if (num_r > 0)
+    {
+      while (num_r--)
+      {
+        std::swap(array[base_r - offsets_r[start_r + num_r]], array[first]);
+        ++first;
+      }
+    }
+  }
+
+  int pivot_idx = first - 1;
+  array[start] = std::move(array[pivot_idx]);
+  array[pivot_idx] = std::move(pivot_val);
+  return pivot_idx;
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::partition_left(int start, int end, const Less &less)
+{
+  // puts elements equal to the pivot on the left; the pivot is known
+  // to be the smallest value in the range
+  T pivot_val = std::move(array[start]);
+  int first = start;
+  int last = end + 1;
+
+  while (less(pivot_val, array[--last]))
+  {
+  }
+  if (last == end)
+  {
+    while (first < last and not less(pivot_val, array[++first]))
+    {
+    }
+  }
+  else
+  {
+    while (not less(pivot_val, array[++first]))
+    {
+    }
+  }
+
+  while (first < last)
+  {
+    std::swap(array[first], array[last]);
+    while (less(pivot_val, array[--last]))
+    {
+    }
+    while (not less(pivot_val, array[++first]))
+    {
+    }
+  }
+
+  array[start] = std::move(array[last]);
+  array[last] = std::move(pivot_val);
+  return last;
+}
+
+template <typename T>
+template <typename Less>
+bool ArraySeq<T>::partial_insertion_sort(int start, int end, const Less &less)
+{
+  // insertion sort that gives up once more than a few elements have
+  // been moved; returns true if the range ended up sorted
+  const int move_limit = 8;
+  int moved = 0;
+  for (int i = start + 1; i <= end; ++i)
+  {
+    if (less(array[i], array[i - 1]))
+    {
+      T hold = std::move(array[i]);
+      int j = i;
+      do
+      {
+        array[j] = std::move(array[j - 1]);
+        --j;
+      } while (j > start and less(hold, array[j - 1]));
+      array[j] = std::move(hold);
+      moved += i - j;
+    }
+    if (moved > move_limit)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::sort3(int a, int b, int c, const Less &less)
+{
+  if (less(array[b], array[a]))
+  {
+    std::swap(array[a], array[b]);
+  }
+  if (less(array[c], array[b]))
+  {
+    std::swap(array[b], array[c]);
+    if (less(array[b], array[a]))
+    {
+      std::swap(array[a], array[b]);
+    }
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::buffered_merge_sort(T *buffer, int start, int end,
+                                      bool to_buffer, const Less &less)
+{
+  // sorts array[start..end], leaving the result in buffer[start..end]
+  // if to_buffer is set and in array[start..end] otherwise
+  if (end - start + 1 <= INSERTION_SORT_CUTOFF)
+  {
+    insertion_sort(start, end, less);
+    if (to_buffer)
+    {
+      for (int i = start; i <= end; ++i)
+      {
+        buffer[i] = std::move(array[i]);
+      }
+    }
+    return;
+  }
+
+  // sort both halves into the other storage, then merge back
+  int mid = start + (end - start) / 2;
+  buffered_merge_sort(buffer, start, mid, not to_buffer, less);
+  buffered_merge_sort(buffer, mid + 1, end, not to_buffer, less);
+  if (to_buffer)
+  {
+    merge_move(array, start, mid, end, buffer, less);
+  }
+  else
+  {
+    merge_move(buffer, start, mid, end, array, less);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::merge_move(T *src, int start, int mid, int end, T *dst,
+                             const Less &less)
+{
+  // merges src[start..mid] and src[mid+1..end] into dst[start..end],
+  // taking from the left run on ties to stay stable
+  int first = start, second = mid + 1, i = start;
+  while (first <= mid and second <= end)
+  {
+    if (less(src[second], src[first]))
+    {
+      dst[i++] = std::move(src[second++]);
+    }
+    else
+    {
+      dst[i++] = std::move(src[first++]);
+    }
+  }
+  while (first <= mid)
+  {
+    dst[i++] = std::move(src[first++]);
+  }
+  while (second <= end)
+  {
+    dst[i++] = std::move(src[second++]);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::merge_move_ranges(T *src, int first, int first_end, int second,
+                                    int second_end, T *dst, int out,
+                                    const Less &less)
+{
+  // merges src[first..first_end) and src[second..second_end) into dst
+  // starting at out, taking from the first run on ties
+  while (first < first_end and second < second_end)
+  {
+    if (less(src[second], src[first]))
+    {
+      dst[out++] = std::move(src[second++]);
+    }
+    else
+    {
+      dst[out++] = std::move(src[first++]);
+    }
+  }
+  out = std::move(src + first, src + first_end, dst + out) - dst;
+  std::move(src + second, src + second_end, dst + out);
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::count_run(int lo, int hi, const Less &less)
+{
+  // length of the run starting at lo (hi exclusive), reversing it if
+  // it is strictly descending
+  int run_hi = lo + 1;
+  if (run_hi == hi)
+  {
+    return 1;
+  }
+  if (less(array[run_hi++], array[lo]))
+  {
+    while (run_hi < hi and less(array[run_hi], array[run_hi - 1]))
+    {
+      ++run_hi;
+    }
+    std::reverse(array + lo, array + run_hi);
+  }
+  else
+  {
+    while (run_hi < hi and not less(array[run_hi], array[run_hi - 1]))
+    {
+      ++run_hi;
+    }
+  }
+  return run_hi - lo;
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::binary_insertion_sort(int lo, int hi, int start, const Less &less)
+{
+  // sorts [lo, hi) given that [lo, start) is already sorted
+  if (start == lo)
+  {
+    ++start;
+  }
+  for (; start < hi; ++start)
+  {
+    T pivot_val = std::move(array[start]);
+    int left = lo, right = start;
+    while (left < right)
+    {
+      int mid = left + (right - left) / 2;
+      if (less(pivot_val, array[mid]))
+      {
+        right = mid;
+      }
+      else
+      {
+        left = mid + 1;
+      }
+    }
+    std::move_backward(array + left, array + start, array + start + 1);
+    array[left] = std::move(pivot_val);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::tim_merge_collapse(TimState &state, const Less &less)
+{
+  // keeps run_len[i-2] > run_len[i-1] + run_len[i] and
+  // run_len[i-1] > run_len[i] for the runs on the stack
+  int *len = state.run_len;
+  while (state.runs > 1)
+  {
+    int n = state.runs - 2;
+    if ((n > 0 and len[n - 1] <= len[n] + len[n + 1]) or
+        (n > 1 and len[n - 2] <= len[n] + len[n - 1]))
+    {
+      if (len[n - 1] < len[n + 1])
+      {
+        --n;
+      }
+    }
+    else if (len[n] > len[n + 1])
+    {
+      break;
+    }
+    tim_merge_at(state, n, less);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::tim_merge_at(TimState &state, int i, const Less &less)
+{
+  int base1 = state.run_base[i];
+  int len1 = state.run_len[i];
+  int base2 = state.run_base[i + 1];
+  int len2 = state.run_len[i + 1];
+
+  state.run_len[i] = len1 + len2;
+  if (i == state.runs - 3)
+  {
+    state.run_base[i + 1] = state.run_base[i + 2];
+    state.run_len[i + 1] = state.run_len[i + 2];
+  }
+  --state.runs;
+
+  // elements of run1 before the start of run2 and elements of run2
+  // after the end of run1 are already in place
+  int k = gallop_right(array[base2], array, base1, len1, 0, less);
+  base1 += k;
+  len1 -= k;
+  if (len1 == 0)
+  {
+    return;
+  }
+  len2 = gallop_left(array[base1 + len1 - 1], array, base2, len2, len2 - 1, less);
+  if (len2 == 0)
+  {
+    return;
+  }
+
+  if (len1 <= len2)
+  {
+    tim_merge_lo(state, base1, len1, base2, len2, less);
+  }
+  else
+  {
+    tim_merge_hi(state, base1, len1, base2, len2, less);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::tim_merge_lo(TimState &state, int base1, int len1, int base2,
+                               int len2, const Less &less)
+{
+  // merges left to right with run1 moved out to the temp buffer;
+  // run1's last element is larger than every element of run2 and
+  // run2's first element is smaller than every element of run1
+  T *tmp = tim_tmp(state, len1);
+  std::move(array + base1, array + base1 + len1, tmp);
+  int cursor1 = 0, cursor2 = base2, dest = base1;
+
+  array[dest++] = std::move(array[cursor2++]);
+  if (--len2 == 0)
+  {
+    std::move(tmp + cursor1, tmp + cursor1 + len1, array + dest);
+    return;
+  }
+  if (len1 == 1)
+  {
+    std::move(array + cursor2, array + cursor2 + len2, array + dest);
+    array[dest + len2] = std::move(tmp[cursor1]);
+    return;
+  }
+
+  int min_gallop = state.min_gallop;
+  bool done = false;
+  while (not done)
+  {
+    // one element at a time until one run wins min_gallop in a row
+    int count1 = 0, count2 = 0;
+    do
+    {
+      if (less(array[cursor2], tmp[cursor1]))
+      {
+        array[dest++] = std::move(array[cursor2++]);
+        ++count2;
+        count1 = 0;
+        if (--len2 == 0)
+        {
+          done = true;
+        }
+      }
+      else
+      {
+        array[dest++] = std::move(tmp[cursor1++]);
+        ++count1;
+        count2 = 0;
+        if (--len1 == 1)
+        {
+          done = true;
+        }
+      }
+    } while (not done and (count1 | count2) < min_gallop);
+
+    // then gallop while runs of winners stay long
+    while (not done)
+    {
+      count1 = gallop_right(array[cursor2], tmp, cursor1, len1, 0, less);
+      if (count1 != 0)
+      {
+        std::move(tmp + cursor1, tmp + cursor1 + count1, array + dest);
+        dest += count1;
+        cursor1 += count1;
+        len1 -= count1;
+        if (len1 <= 1)
+        {
+          done = true;
+          break;
+        }
+      }
+      array[dest++] = std::move(array[cursor2++]);
+      if (--len2 == 0)
+      {
+        done = true;
+        break;
+      }
+
+      count2 = gallop_left(tmp[cursor1], array, cursor2, len2, 0, less);
+      if (count2 != 0)
+      {
+        std::move(array + cursor2, array + cursor2 + count2, array + dest);
+        dest += count2;
+        cursor2 += count2;
+        len2 -= count2;
+        if (len2 == 0)
+        {
+          done = true;
+          break;
+        }
+      }
+      array[dest++] = std::move(tmp[cursor1++]);
+      if (--len1 == 1)
+      {
+        done = true;
+        break;
+      }
+
+      --min_gallop;
+      if (count1 < TIM_MIN_GALLOP and count2 < TIM_MIN_GALLOP)
+      {
+        break;
+      }
+    }
+    if (not done)
+    {
+      // penalize leaving gallop mode
+      if (min_gallop < 0)
+      {
+        min_gallop = 0;
+      }
+      min_gallop += 2;
+    }
+  }
+  state.min_gallop = min_gallop < 1 ? 1 : min_gallop;
+
+  if (len1 == 1)
+  {
+    std::move(array + cursor2, array + cursor2 + len2, array + dest);
+    array[dest + len2] = std::move(tmp[cursor1]);
+  }
+  else if (len1 == 0)
+  {
+    throw std::logic_error("Comparison method violates its general contract");
+  }
+  else
+  {
+    std::move(tmp + cursor1, tmp + cursor1 + len1, array + dest);
+  }
+}
+
+template <typename T>
+template <typename Less>
+void ArraySeq<T>::tim_merge_hi(TimState &state, int base1, int len1, int base2,
+                               int len2, const Less &less)
+{
+  // mirror image of tim_merge_lo(): merges right to left with run2
+  // moved out to the temp buffer
+  T *tmp = tim_tmp(state, len2);
+  std::move(array + base2, array + base2 + len2, tmp);
+  int cursor1 = base1 + len1 - 1, cursor2 = len2 - 1, dest = base2 + len2 - 1;
+
+  array[dest--] = std::move(array[cursor1--]);
+  if (--len1 == 0)
+  {
+    std::move(tmp, tmp + len2, array + dest - (len2 - 1));
+    return;
+  }
+  if (len2 == 1)
+  {
+    dest -= len1;
+    cursor1 -= len1;
+    std::move_backward(array + cursor1 + 1, array + cursor1 + 1 + len1,
+                       array + dest + 1 + len1);
+    array[dest] = std::move(tmp[cursor2]);
+    return;
+  }
+
+  int min_gallop = state.min_gallop;
+  bool done = false;
+  while (not done)
+  {
+    int count1 = 0, count2 = 0;
+    do
+    {
+      if (less(tmp[cursor2], array[cursor1]))
+      {
+        array[dest--] = std::move(array[cursor1--]);
+        ++count1;
+        count2 = 0;
+        if (--len1 == 0)
+        {
+          done = true;
+        }
+      }
+      else
+      {
+        array[dest--] = std::move(tmp[cursor2--]);
+        ++count2;
+        count1 = 0;
+        if (--len2 == 1)
+        {
+          done = true;
+        }
+      }
+    } while (not done and (count1 | count2) < min_gallop);
+
+    while (not done)
+    {
+      count1 = len1 - gallop_right(tmp[cursor2], array, base1, len1, len1 - 1, less);
+      if (count1 != 0)
+      {
+        dest -= count1;
+        cursor1 -= count1;
+        len1 -= count1;
+        std::move_backward(array + cursor1 + 1, array + cursor1 + 1 + count1,
+                           array + dest + 1 + count1);
+        if (len1 == 0)
+        {
+          done = true;
+          break;
+        }
+      }
+      array[dest--] = std::move(tmp[cursor2--]);
+      if (--len2 == 1)
+      {
+        done = true;
+        break;
+      }
+
+      count2 = len2 - gallop_left(array[cursor1], tmp, 0, len2, len2 - 1, less);
+      if (count2 != 0)
+      {
+        dest -= count2;
+        cursor2 -= count2;
+        len2 -= count2;
+        std::move(tmp + cursor2 + 1, tmp + cursor2 + 1 + count2, array + dest + 1);
+        if (len2 <= 1)
+        {
+          done = true;
+          break;
+        }
+      }
+      array[dest--] = std::move(array[cursor1--]);
+      if (--len1 == 0)
+      {
+        done = true;
+        break;
+      }
+
+      --min_gallop;
+      if (count1 < TIM_MIN_GALLOP and count2 < TIM_MIN_GALLOP)
+      {
+        break;
+      }
+    }
+    if (not done)
+    {
+      if (min_gallop < 0)
+      {
+        min_gallop = 0;
+      }
+      min_gallop += 2;
+    }
+  }
+  state.min_gallop = min_gallop < 1 ? 1 : min_gallop;
+
+  if (len2 == 1)
+  {
+    dest -= len1;
+    cursor1 -= len1;
+    std::move_backward(array + cursor1 + 1, array + cursor1 + 1 + len1,
+                       array + dest + 1 + len1);
+    array[dest] = std::move(tmp[cursor2]);
+  }
+  else if (len2 == 0)
+  {
+    throw std::logic_error("Comparison method violates its general contract");
+  }
+  else
+  {
+    std::move(tmp, tmp + len2, array + dest - (len2 - 1));
+  }
+}
+
+template <typename T>
+T *ArraySeq<T>::tim_tmp(TimState &state, int len)
+{
+  // grows the temp buffer geometrically, capped at half the array
+  if (state.tmp_size < len)
+  {
+    int new_size = state.tmp_size == 0 ? 256 : state.tmp_size * 2;
+    if (new_size < len)
+    {
+      new_size = len;
+    }
+    if (new_size > size() / 2 and len <= size() / 2)
+    {
+      new_size = size() / 2;
+    }
+    state.tmp.reset(new_size, array, size());
+    state.tmp_size = new_size;
+  }
+  return state.tmp.get();
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::gallop_left(const T &key, const T *a, int base, int len,
+                             int hint, const Less &less)
+{
+  // returns k such that a[base+k-1] < key <= a[base+k], searching
+  // outward from hint in exponentially growing steps and then
+  // finishing with a binary search
+  int last_ofs = 0, ofs = 1;
+  if (less(a[base + hint], key))
+  {
+    int max_ofs = len - hint;
+    while (ofs < max_ofs and less(a[base + hint + ofs], key))
+    {
+      last_ofs = ofs;
+      ofs = ofs <= (max_ofs - 1) / 2 ? 2 * ofs + 1 : max_ofs;
+    }
+    if (ofs > max_ofs)
+    {
+      ofs = max_ofs;
+    }
+    last_ofs += hint;
+    ofs += hint;
+  }
+  else
+  {
+    int max_ofs = hint + 1;
+    while (ofs < max_ofs and not less(a[base + hint - ofs], key))
+    {
+      last_ofs = ofs;
+      ofs = ofs <= (max_ofs - 1) / 2 ? 2 * ofs + 1 : max_ofs;
+    }
+    if (ofs > max_ofs)
+    {
+      ofs = max_ofs;
+    }
+    int hold = last_ofs;
+    last_ofs = hint - ofs;
+    ofs = hint - hold;
+  }
+
+  ++last_ofs;
+  while (last_ofs < ofs)
+  {
+    int mid = last_ofs + (ofs - last_ofs) / 2;
+    if (less(a[base + mid], key))
+    {
+      last_ofs = mid + 1;
+    }
+    else
+    {
+      ofs = mid;
+    }
+  }
+  return ofs;
+}
+
+template <typename T>
+template <typename Less>
+int ArraySeq<T>::gallop_right(const T &key, const T *a, int base, int len,
+                              int hint, const Less &less)
+{
+  // returns k such that a[base+k-1] <= key < a[base+k]
+  int last_ofs = 0, ofs = 1;
+  if (less(key, a[base + hint]))
+  {
+    int max_ofs = hint + 1;
+    while (ofs < max_ofs and less(key, a[base + hint - ofs]))
+    {
+      last_ofs = ofs;
+      ofs = ofs <= (max_ofs - 1) / 2 ? 2 * ofs + 1 : max_ofs;
+    }
+    if (ofs > max_ofs)
+    {
+      ofs = max_ofs;
+    }
+    int hold = last_ofs;
+    last_ofs = hint - ofs;
+    ofs = hint - hold;
+  }
+  else
+  {
+    int max_ofs = len - hint;
+    while (ofs < max_ofs and not less(key, a[base + hint + ofs]))
+    {
+      last_ofs = ofs;
+      ofs = ofs <= (max_ofs - 1) / 2 ? 2 * ofs + 1 : max_ofs;
+    }
+    if (ofs > max_ofs)
+    {
+      ofs = max_ofs;
+    }
+    last_ofs += hint;
+    ofs += hint;
+  }
+
+  ++last_ofs;
+  while (last_ofs < ofs)
+  {
+    int mid = last_ofs + (ofs - last_ofs) / 2;
+    if (less(key, a[base + mid]))
+    {
+      ofs = mid;
+    }
+    else
+    {
+      last_ofs = mid + 1;
+    }
   }
+  return ofs;
 }
 
 #endif
@@ -11,60 +11,246 @@
 //       sequences. To save this data to a file, run the command:
 //          ./hw4_perf > output.dat
 //       This file can then be used by the plotting script to generate
-//       the corresponding performance graphs.
+//       the corresponding performance graphs. To measure how a
+//       parallel sort scales with thread count, run:
+//          ./hw4_perf <radix|quick|merge|sample> [n] [max_threads]
+//       To compare binary search with the Eytzinger search index on
+//       n sorted ints, run:
+//          ./hw4_perf search [n]
+//       and to compare the scalar and vectorized unsorted contains()
+//       scans on n ints:
+//          ./hw4_perf scan [n]
+//       and to compare the pooled and heap LinkedSeq node allocators:
+//          ./hw4_perf nodes [n]
+//       and to compare LinkedSeq with the unrolled and the arena
+//       (index linked) lists:
+//          ./hw4_perf unrolled [n]
+//       and to time traversal of a sorted LinkedSeq before and after
+//       compact():
+//          ./hw4_perf compact [n]
 //---------------------------------------------------------------------------
 
 #include <iostream>
 #include <iomanip>
 #include <chrono>
 #include <functional>
+#include <string>
+#include <thread>
+#include <vector>
 #include "util.h"
 #include "sequence.h"
 #include "arrayseq.h"
 #include "linkedseq.h"
+#include "searchindex.h"
+#include "unrolledseq.h"
+#include "arenaseq.h"
 
 
 using namespace std;
 using namespace std::chrono;
 
-typedef function<void(ArraySeq<int>&)> array_sort_fn;
-typedef function<void(LinkedSeq<int>&)> linked_sort_fn;
+template <typename T>
+using array_sort_fn = void (*)(ArraySeq<T>&);
+template <typename T>
+using linked_sort_fn = void (*)(LinkedSeq<T>&);
+typedef function<void(ArraySeq<int>&, int)> parallel_sort_fn;
 
 // helper functions for sorting
-void array_merge_sort(ArraySeq<int>& s)
+template <typename T>
+void array_merge_sort(ArraySeq<T>& s)
 {
   s.merge_sort();
 }
 
-void array_quick_sort(ArraySeq<int>& s)
+template <typename T>
+void array_quick_sort(ArraySeq<T>& s)
 {
   s.quick_sort();
 }
 
-void array_quick_sort_random(ArraySeq<int>& s)
+template <typename T>
+void array_quick_sort_random(ArraySeq<T>& s)
 {
   s.quick_sort_random();
 }
 
-void linked_merge_sort(LinkedSeq<int>& s)
+template <typename T>
+void array_intro_sort(ArraySeq<T>& s)
+{
+  s.intro_sort();
+}
+
+template <typename T>
+void array_block_quick_sort(ArraySeq<T>& s)
+{
+  s.block_quick_sort();
+}
+
+template <typename T>
+void array_buffered_merge_sort(ArraySeq<T>& s)
+{
+  s.buffered_merge_sort();
+}
+
+template <typename T>
+void array_bottom_up_merge_sort(ArraySeq<T>& s)
+{
+  s.bottom_up_merge_sort();
+}
+
+template <typename T>
+void array_tim_sort(ArraySeq<T>& s)
+{
+  s.tim_sort();
+}
+
+template <typename T>
+void array_radix_sort(ArraySeq<T>& s)
+{
+  s.radix_sort();
+}
+
+template <typename T>
+void array_three_way_quick_sort(ArraySeq<T>& s)
+{
+  s.three_way_quick_sort();
+}
+
+template <typename T>
+void array_dual_pivot_quick_sort(ArraySeq<T>& s)
+{
+  s.dual_pivot_quick_sort();
+}
+
+template <typename T>
+void linked_merge_sort(LinkedSeq<T>& s)
 {
   s.merge_sort();
 }
 
-void linked_quick_sort(LinkedSeq<int>& s)
+template <typename T>
+void linked_quick_sort(LinkedSeq<T>& s)
 {
   s.quick_sort();
 }
 
-void linked_quick_sort_random(LinkedSeq<int>& s)
+template <typename T>
+void linked_quick_sort_random(LinkedSeq<T>& s)
 {
   s.quick_sort_random();
 }
 
+template <typename T>
+void linked_bottom_up_merge_sort(LinkedSeq<T>& s)
+{
+  s.bottom_up_merge_sort();
+}
+
+template <typename T>
+void linked_natural_merge_sort(LinkedSeq<T>& s)
+{
+  s.natural_merge_sort();
+}
+
+template <typename T>
+void linked_three_way_quick_sort(LinkedSeq<T>& s)
+{
+  s.three_way_quick_sort();
+}
+
+// helper functions for parallel sorting
+void array_parallel_radix_sort(ArraySeq<int>& s, int threads)
+{
+  s.parallel_radix_sort(threads);
+}
+
+void array_parallel_quick_sort(ArraySeq<int>& s, int threads)
+{
+  s.parallel_quick_sort(threads);
+}
+
+void array_parallel_merge_sort(ArraySeq<int>& s, int threads)
+{
+  s.parallel_merge_sort(threads);
+}
+
+void array_parallel_sample_sort(ArraySeq<int>& s, int threads)
+{
+  s.parallel_sample_sort(threads);
+}
+
+// Record with an int key and heap-allocated members, so copying one
+// costs a few allocations while moving one is a handful of pointer
+// swaps. Used with std::string to time the sorts on element types
+// that are not trivially copyable.
+struct HeavyRecord
+{
+  int key;
+  string name;
+  vector<double> payload;
+};
+
+bool operator<(const HeavyRecord& lhs, const HeavyRecord& rhs)
+{
+  return lhs.key < rhs.key;
+}
+
+bool operator==(const HeavyRecord& lhs, const HeavyRecord& rhs)
+{
+  return lhs.key == rhs.key;
+}
+
+ostream& operator<<(ostream& out, const HeavyRecord& r)
+{
+  return out << r.key;
+}
+
+// string that sorts in the same order as value (for value >= 0) and is
+// too long for the small string optimization, so copies allocate
+string string_key(int value)
+{
+  string digits = to_string(value);
+  return string(24 - digits.size(), '0') + digits;
+}
+
+HeavyRecord heavy_record(int value)
+{
+  return HeavyRecord{value, string_key(value), vector<double>(16, value)};
+}
+
 // helper functions for timing and simple sort check
-double array_timed(const ArraySeq<int>& seq, array_sort_fn f);
-double linked_timed(const LinkedSeq<int>& seq, linked_sort_fn f);
-void check_sorted(const Sequence<int>& s);
+template <typename T>
+double array_timed(const ArraySeq<T>& seq, array_sort_fn<T> f);
+template <typename T>
+double linked_timed(const LinkedSeq<T>& seq, linked_sort_fn<T> f);
+template <typename T>
+void check_sorted(Sequence<T>& s);
+
+// thread scaling benchmark, on random ints or (keys > 0) on ints
+// with that many distinct values
+void thread_benchmark(const string& name, parallel_sort_fn f, int n,
+                      int max_threads, int keys = 0);
+
+// sorted lookup benchmark
+void search_benchmark(int n);
+
+// unsorted lookup benchmark
+void scan_benchmark(int n);
+
+// linked list node allocator benchmark
+template <template <typename> class NodeAlloc>
+void node_benchmark(const string& name, int n);
+
+// sorted linked list traversal benchmark
+void compact_benchmark(int n);
+
+// linked list layout benchmark
+template <typename Seq>
+void list_benchmark(const string& name, int n);
+
+// milliseconds for one full traversal of seq, averaged over 10
+template <typename Seq>
+double traversal_msec(const Seq& seq);
 
 // test parameters
 const int start = 0;
@@ -72,6 +258,7 @@ const int step = 1500;
 const int stop = 15000;
 const int runs = 1;
 const int shuffles = 5;
+const int unique_keys = 10;
 
 
 int main(int argc, char* argv[])
@@ -80,6 +267,56 @@ int main(int argc, char* argv[])
   cout << fixed << showpoint;
   cout << setprecision(2);
 
+  if (argc > 1) {
+    string mode = argv[1];
+    int n = argc > 2 ? stoi(argv[2]) : 10000000;
+    int max_threads = argc > 3 ? stoi(argv[3]) : thread::hardware_concurrency();
+    if (mode == "radix")
+      thread_benchmark(mode, array_parallel_radix_sort, n, max_threads);
+    else if (mode == "quick")
+      thread_benchmark(mode, array_parallel_quick_sort, n, max_threads);
+    else if (mode == "merge")
+      thread_benchmark(mode, array_parallel_merge_sort, n, max_threads);
+    else if (mode == "sample")
+      thread_benchmark(mode, array_parallel_sample_sort, n, max_threads);
+    else if (mode == "sample_few")
+      thread_benchmark("sample", array_parallel_sample_sort, n, max_threads,
+                       unique_keys);
+    else if (mode == "search")
+      search_benchmark(n);
+    else if (mode == "scan")
+      scan_benchmark(n);
+    else if (mode == "nodes") {
+      cout << "# Linked list of " << n << " ints" << endl;
+      cout << "# Column 1 = node allocator (pool, heap)" << endl;
+      cout << "# Column 2 = build time (msec)" << endl;
+      cout << "# Column 3 = copy time (msec)" << endl;
+      cout << "# Column 4 = merge sort time (msec)" << endl;
+      cout << "# Column 5 = clear time (msec)" << endl;
+      // pool first: glibc consolidates the heap run's freed nodes on
+      // the next large allocation, which would be charged to the pool
+      node_benchmark<PoolNodeAllocator>("pool", n);
+      node_benchmark<HeapNodeAllocator>("heap", n);
+    }
+    else if (mode == "compact")
+      compact_benchmark(n);
+    else if (mode == "unrolled") {
+      cout << "# List of " << n << " ints" << endl;
+      cout << "# Column 1 = list (linked, unrolled, arena)" << endl;
+      cout << "# Column 2 = build time (msec)" << endl;
+      cout << "# Column 3 = full traversal time (msec)" << endl;
+      cout << "# Column 4 = merge sort time (msec)" << endl;
+      list_benchmark<LinkedSeq<int>>("linked", n);
+      list_benchmark<UnrolledSeq<int>>("unrolled", n);
+      list_benchmark<ArenaSeq<int>>("arena", n);
+    }
+    else {
+      cerr << "Unknown benchmark: " << mode << endl;
+      return 1;
+    }
+    return 0;
+  }
+
   // output data header
   cout << "# All times in milliseconds (msec)" << endl;
   cout << "# Column 1 = input data size" << endl;
@@ -102,16 +339,80 @@ int main(int argc, char* argv[])
   cout << "# Column 12 = avg time linked quick sort random, reversed" << endl;
   cout << "# Column 13 = avg time linked quick sort random, shuffled" << endl;
 
+  cout << "# Column 14 = avg time array intro sort, reversed" << endl;
+  cout << "# Column 15 = avg time array intro sort, shuffled" << endl;
+
+  cout << "# Column 16 = avg time array block quick sort, reversed" << endl;
+  cout << "# Column 17 = avg time array block quick sort, shuffled" << endl;
+
+  cout << "# Column 18 = avg time array buffered merge sort, reversed" << endl;
+  cout << "# Column 19 = avg time array buffered merge sort, shuffled" << endl;
+
+  cout << "# Column 20 = avg time array bottom-up merge sort, reversed" << endl;
+  cout << "# Column 21 = avg time array bottom-up merge sort, shuffled" << endl;
+
+  cout << "# Column 22 = avg time linked bottom-up merge sort, reversed" << endl;
+  cout << "# Column 23 = avg time linked bottom-up merge sort, shuffled" << endl;
+
+  cout << "# Column 24 = avg time array tim sort, reversed" << endl;
+  cout << "# Column 25 = avg time array tim sort, shuffled" << endl;
+
+  cout << "# Column 26 = avg time linked natural merge sort, reversed" << endl;
+  cout << "# Column 27 = avg time linked natural merge sort, shuffled" << endl;
+
+  cout << "# Column 28 = avg time array radix sort, reversed" << endl;
+  cout << "# Column 29 = avg time array radix sort, shuffled" << endl;
+
+  cout << "# Column 30 = avg time array three-way quick sort, reversed" << endl;
+  cout << "# Column 31 = avg time array three-way quick sort, shuffled" << endl;
+
+  cout << "# Column 32 = avg time linked three-way quick sort, reversed" << endl;
+  cout << "# Column 33 = avg time linked three-way quick sort, shuffled" << endl;
+
+  cout << "# Column 34 = avg time array quick sort random, few unique" << endl;
+  cout << "# Column 35 = avg time array three-way quick sort, few unique" << endl;
+
+  cout << "# Column 36 = avg time linked quick sort random, few unique" << endl;
+  cout << "# Column 37 = avg time linked three-way quick sort, few unique" << endl;
+  cout << "# Column 38 = avg time array dual-pivot quick sort, reversed" << endl;
+  cout << "# Column 39 = avg time array dual-pivot quick sort, shuffled" << endl;
+
+  cout << "# Column 40 = avg time array merge sort, shuffled strings" << endl;
+  cout << "# Column 41 = avg time array quick sort random, shuffled strings" << endl;
+  cout << "# Column 42 = avg time array intro sort, shuffled strings" << endl;
+  cout << "# Column 43 = avg time array tim sort, shuffled strings" << endl;
+  cout << "# Column 44 = avg time linked quick sort random, shuffled strings" << endl;
+
+  cout << "# Column 45 = avg time array merge sort, shuffled records" << endl;
+  cout << "# Column 46 = avg time array quick sort random, shuffled records" << endl;
+  cout << "# Column 47 = avg time array intro sort, shuffled records" << endl;
+  cout << "# Column 48 = avg time array tim sort, shuffled records" << endl;
+  cout << "# Column 49 = avg time linked quick sort random, shuffled records" << endl;
+
   
   // run tests and print test results
   for (int size = start; size <= stop; size += step) {
 
-    ArraySeq<int> array_reversed, array_shuffled;
-    LinkedSeq<int> linked_reversed, linked_shuffled;
+    ArraySeq<int> array_reversed, array_shuffled, array_few_unique;
+    LinkedSeq<int> linked_reversed, linked_shuffled, linked_few_unique;
     load_reverse_order(array_reversed, size);
     load_shuffled(array_shuffled, size, shuffles);
+    load_few_unique(array_few_unique, size, unique_keys);
     load_reverse_order(linked_reversed, size);
     load_shuffled(linked_shuffled, size, shuffles);
+    load_few_unique(linked_few_unique, size, unique_keys);
+
+    // same shuffled order, as long strings and as heavy records
+    ArraySeq<string> array_strings;
+    LinkedSeq<string> linked_strings;
+    ArraySeq<HeavyRecord> array_records;
+    LinkedSeq<HeavyRecord> linked_records;
+    for (int i = 0; i < size; ++i) {
+      array_strings.insert(string_key(array_shuffled[i]), i);
+      linked_strings.insert(string_key(array_shuffled[i]), i);
+      array_records.insert(heavy_record(array_shuffled[i]), i);
+      linked_records.insert(heavy_record(array_shuffled[i]), i);
+    }
 
     double c2 = array_timed(array_reversed, array_merge_sort);
     double c3 = array_timed(array_shuffled, array_merge_sort);
@@ -131,19 +432,79 @@ int main(int argc, char* argv[])
     double c12 = linked_timed(linked_reversed, linked_quick_sort_random);
     double c13 = linked_timed(linked_shuffled, linked_quick_sort_random);
 
+    double c14 = array_timed(array_reversed, array_intro_sort);
+    double c15 = array_timed(array_shuffled, array_intro_sort);
+
+    double c16 = array_timed(array_reversed, array_block_quick_sort);
+    double c17 = array_timed(array_shuffled, array_block_quick_sort);
+
+    double c18 = array_timed(array_reversed, array_buffered_merge_sort);
+    double c19 = array_timed(array_shuffled, array_buffered_merge_sort);
+
+    double c20 = array_timed(array_reversed, array_bottom_up_merge_sort);
+    double c21 = array_timed(array_shuffled, array_bottom_up_merge_sort);
+
+    double c22 = linked_timed(linked_reversed, linked_bottom_up_merge_sort);
+    double c23 = linked_timed(linked_shuffled, linked_bottom_up_merge_sort);
+
+    double c24 = array_timed(array_reversed, array_tim_sort);
+    double c25 = array_timed(array_shuffled, array_tim_sort);
+
+    double c26 = linked_timed(linked_reversed, linked_natural_merge_sort);
+    double c27 = linked_timed(linked_shuffled, linked_natural_merge_sort);
+
+    double c28 = array_timed(array_reversed, array_radix_sort);
+    double c29 = array_timed(array_shuffled, array_radix_sort);
+
+    double c30 = array_timed(array_reversed, array_three_way_quick_sort);
+    double c31 = array_timed(array_shuffled, array_three_way_quick_sort);
+
+    double c32 = linked_timed(linked_reversed, linked_three_way_quick_sort);
+    double c33 = linked_timed(linked_shuffled, linked_three_way_quick_sort);
+
+    double c34 = array_timed(array_few_unique, array_quick_sort_random);
+    double c35 = array_timed(array_few_unique, array_three_way_quick_sort);
+
+    double c36 = linked_timed(linked_few_unique, linked_quick_sort_random);
+    double c37 = linked_timed(linked_few_unique, linked_three_way_quick_sort);
+    double c38 = array_timed(array_reversed, array_dual_pivot_quick_sort);
+    double c39 = array_timed(array_shuffled, array_dual_pivot_quick_sort);
+
+    double c40 = array_timed(array_strings, array_merge_sort);
+    double c41 = array_timed(array_strings, array_quick_sort_random);
+    double c42 = array_timed(array_strings, array_intro_sort);
+    double c43 = array_timed(array_strings, array_tim_sort);
+    double c44 = linked_timed(linked_strings, linked_quick_sort_random);
+
+    double c45 = array_timed(array_records, array_merge_sort);
+    double c46 = array_timed(array_records, array_quick_sort_random);
+    double c47 = array_timed(array_records, array_intro_sort);
+    double c48 = array_timed(array_records, array_tim_sort);
+    double c49 = linked_timed(linked_records, linked_quick_sort_random);
+
     cout << size << " " << c2 << " " << c3 << " " << c4 << " "
 	 << c5 << " " << c6 << " " << c7 << " " << c8 << " "
 	 << c9 << " " << c10 << " " << c11 << " " << c12 << " "
-         << c13 << endl;
+         << c13 << " " << c14 << " " << c15 << " " << c16 << " "
+         << c17 << " " << c18 << " " << c19 << " " << c20 << " "
+         << c21 << " " << c22 << " " << c23 << " " << c24 << " "
+         << c25 << " " << c26 << " " << c27 << " " << c28 << " "
+         << c29 << " " << c30 << " " << c31 << " " << c32 << " "
+         << c33 << " " << c34 << " " << c35 << " " << c36 << " "
+         << c37 << " " << c38 << " " << c39 << " " << c40 << " "
+         << c41 << " " << c42 << " " << c43 << " " << c44 << " "
+         << c45 << " " << c46 << " " << c47 << " " << c48 << " "
+         << c49 << endl;
   }
 
 }
 
-double array_timed(const ArraySeq<int>& seq, array_sort_fn f)
+template <typename T>
+double array_timed(const ArraySeq<T>& seq, array_sort_fn<T> f)
 {
   int total = 0;
   for (int r = 0; r < runs; ++r) {
-    ArraySeq<int> s = seq;
+    ArraySeq<T> s = seq;
     auto t0 = high_resolution_clock::now();
     f(s);
     auto t1 = high_resolution_clock::now();
@@ -153,11 +514,12 @@ double array_timed(const ArraySeq<int>& seq, array_sort_fn f)
   return (total * 1.0) / runs;
 }
 
-double linked_timed(const LinkedSeq<int>& seq, linked_sort_fn f)
+template <typename T>
+double linked_timed(const LinkedSeq<T>& seq, linked_sort_fn<T> f)
 {
   int total = 0;
   for (int r = 0; r < runs; ++r) {
-    LinkedSeq<int> s = seq;
+    LinkedSeq<T> s = seq;
     auto t0 = high_resolution_clock::now();
     f(s);
     auto t1 = high_resolution_clock::now();
@@ -167,10 +529,54 @@ double linked_timed(const LinkedSeq<int>& seq, linked_sort_fn f)
   return (total * 1.0) / runs;
 }
 
-void check_sorted(const Sequence<int>& s)
+void thread_benchmark(const string& name, parallel_sort_fn f, int n,
+                      int max_threads, int keys)
+{
+  ArraySeq<int> seq;
+  if (keys > 0)
+    load_few_unique(seq, n, keys);
+  else {
+    // pseudo-random keys from a fixed linear congruential generator
+    unsigned int x = 22;
+    for (int i = 0; i < n; ++i) {
+      x = x * 1664525u + 1013904223u;
+      seq.insert(static_cast<int>(x), i);
+    }
+  }
+
+  if (max_threads < 1)
+    max_threads = 1;
+
+  cout << "# Parallel " << name << " sort of " << n;
+  if (keys > 0)
+    cout << " ints with " << keys << " unique keys" << endl;
+  else
+    cout << " random ints" << endl;
+  cout << "# Column 1 = thread count" << endl;
+  cout << "# Column 2 = time (msec)" << endl;
+  cout << "# Column 3 = throughput (million elements / sec)" << endl;
+  int threads = 1;
+  while (true) {
+    ArraySeq<int> s = seq;
+    auto t0 = high_resolution_clock::now();
+    f(s, threads);
+    auto t1 = high_resolution_clock::now();
+    check_sorted(s);
+    double msec = duration<double, milli>(t1 - t0).count();
+    cout << threads << " " << msec << " " << (n / 1000.0) / msec << endl;
+    if (threads == max_threads)
+      break;
+    threads = threads * 2 < max_threads ? threads * 2 : max_threads;
+  }
+}
+
+// takes s by non-const reference so LinkedSeq indexing walks on from
+// its finger instead of from head
+template <typename T>
+void check_sorted(Sequence<T>& s)
 {
   for (int i = 0; i < s.size() - 1; ++i) {
-    if (s[i] > s[i+1]) {
+    if (s[i+1] < s[i]) {
       std::cerr << "Error: Sequence not sorted: s[" << i << "] = "
                 << s[i] << " > " << "s[" << (i + 1) << "] = "
                 << s[i+1] << endl;
@@ -178,3 +584,178 @@ void check_sorted(const Sequence<int>& s)
     }
   }
 }
+
+void search_benchmark(int n)
+{
+  // n pseudo-random ints, looked up n times at pseudo-random keys
+  // (about half of them present)
+  ArraySeq<int> seq;
+  unsigned int x = 22;
+  for (int i = 0; i < n; ++i) {
+    x = x * 1664525u + 1013904223u;
+    seq.insert(static_cast<int>(x >> 1), i);
+  }
+  seq.sort();
+  const ArraySeq<int>& sorted = seq;
+  SearchIndex<int> index(sorted);
+  int* keys = new int[n];
+  for (int i = 0; i < n; ++i) {
+    x = x * 1664525u + 1013904223u;
+    keys[i] = x & 1 ? sorted[x % n] : static_cast<int>(x >> 1);
+  }
+
+  cout << "# Sorted lookups of " << n << " random ints" << endl;
+  cout << "# Column 1 = search (binary, eytzinger)" << endl;
+  cout << "# Column 2 = time (msec)" << endl;
+  cout << "# Column 3 = throughput (million lookups / sec)" << endl;
+  int found[2] = {0, 0};
+  for (int mode = 0; mode < 2; ++mode) {
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < n; ++i)
+      found[mode] += mode == 0 ? sorted.contains(keys[i]) : index.contains(keys[i]);
+    auto t1 = high_resolution_clock::now();
+    double msec = duration<double, milli>(t1 - t0).count();
+    cout << (mode == 0 ? "binary" : "eytzinger") << " " << msec << " "
+         << (n / 1000.0) / msec << endl;
+  }
+  if (found[0] != found[1])
+    std::cerr << "Error: lookups disagree: " << found[0] << " != "
+              << found[1] << endl;
+  delete[] keys;
+}
+
+void scan_benchmark(int n)
+{
+  // n ints, scanned for 1000 pseudo-random keys (about half of them
+  // present, so a scan covers 3/4 of the ints on average)
+  const int lookups = 1000;
+  int* data = new int[n];
+  for (int i = 0; i < n; ++i)
+    data[i] = 2 * i;
+  unsigned int x = 22;
+  int keys[lookups];
+  for (int i = 0; i < lookups; ++i) {
+    x = x * 1664525u + 1013904223u;
+    keys[i] = static_cast<int>(x % n) * 2 + (x >> 31);
+  }
+
+  cout << "# Unsorted lookups in " << n << " ints" << endl;
+  cout << "# Column 1 = scan (scalar, sse4.2, avx2)" << endl;
+  cout << "# Column 2 = time (msec)" << endl;
+  cout << "# Column 3 = throughput (million ints scanned / sec)" << endl;
+  const char* names[] = {"scalar", "sse4.2", "avx2"};
+  SimdLevel levels[] = {SIMD_NONE, SIMD_SSE42, SIMD_AVX2};
+  int found[3] = {0, 0, 0};
+  double scanned[3] = {0, 0, 0};
+  for (int l = 0; l < 3; ++l) {
+    if (levels[l] > simd_level())
+      continue;
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < lookups; ++i) {
+      int at = simd_find(data, n, keys[i], levels[l]);
+      found[l] += at >= 0;
+      scanned[l] += at >= 0 ? at + 1 : n;
+    }
+    auto t1 = high_resolution_clock::now();
+    double msec = duration<double, milli>(t1 - t0).count();
+    cout << names[l] << " " << msec << " " << (scanned[l] / 1000.0) / msec
+         << endl;
+    if (found[l] != found[0])
+      std::cerr << "Error: lookups disagree: " << found[l] << " != "
+                << found[0] << endl;
+  }
+  delete[] data;
+}
+
+template <template <typename> class NodeAlloc>
+void node_benchmark(const string& name, int n)
+{
+  auto t0 = high_resolution_clock::now();
+  LinkedSeq<int, NodeAlloc> seq;
+  unsigned int x = 22;
+  for (int i = 0; i < n; ++i) {
+    x = x * 1664525u + 1013904223u;
+    seq.insert(static_cast<int>(x), i);
+  }
+  auto t1 = high_resolution_clock::now();
+  LinkedSeq<int, NodeAlloc> copy = seq;
+  auto t2 = high_resolution_clock::now();
+  copy.merge_sort();
+  auto t3 = high_resolution_clock::now();
+  seq.clear();
+  copy.clear();
+  auto t4 = high_resolution_clock::now();
+  cout << name << " " << duration<double, milli>(t1 - t0).count() << " "
+       << duration<double, milli>(t2 - t1).count() << " "
+       << duration<double, milli>(t3 - t2).count() << " "
+       << duration<double, milli>(t4 - t3).count() << endl;
+}
+
+template <typename Seq>
+double traversal_msec(const Seq& seq)
+{
+  // -1 is never inserted, so each lookup walks the whole list
+  int found = 0;
+  auto t0 = high_resolution_clock::now();
+  for (int i = 0; i < 10; ++i)
+    found += seq.contains(-1);
+  auto t1 = high_resolution_clock::now();
+  if (found != 0)
+    std::cerr << "Error: found a missing key" << endl;
+  return duration<double, milli>(t1 - t0).count() / 10;
+}
+
+template <typename Seq>
+void list_benchmark(const string& name, int n)
+{
+  auto t0 = high_resolution_clock::now();
+  Seq seq;
+  unsigned int x = 22;
+  for (int i = 0; i < n; ++i) {
+    x = x * 1664525u + 1013904223u;
+    seq.insert(static_cast<int>(x >> 1), i);
+  }
+  auto t1 = high_resolution_clock::now();
+  double traversal = traversal_msec(seq);
+  auto t2 = high_resolution_clock::now();
+  seq.merge_sort();
+  auto t3 = high_resolution_clock::now();
+  cout << name << " " << duration<double, milli>(t1 - t0).count() << " "
+       << traversal << " " << duration<double, milli>(t3 - t2).count()
+       << endl;
+}
+
+void compact_benchmark(int n)
+{
+  LinkedSeq<int> seq;
+  ArraySeq<int> array;
+  unsigned int x = 22;
+  for (int i = 0; i < n; ++i) {
+    x = x * 1664525u + 1013904223u;
+    seq.insert(static_cast<int>(x >> 1), i);
+    array.insert(static_cast<int>(x >> 1), i);
+  }
+  cout << "# Sorted linked list of " << n << " ints" << endl;
+  cout << "# Column 1 = layout (scattered, compacted, array)" << endl;
+  cout << "# Column 2 = merge sort or compact() time (msec)" << endl;
+  cout << "# Column 3 = full traversal time (msec)" << endl;
+  auto t0 = high_resolution_clock::now();
+  seq.merge_sort();
+  auto t1 = high_resolution_clock::now();
+  cout << "scattered " << duration<double, milli>(t1 - t0).count() << " "
+       << traversal_msec(seq) << endl;
+  t0 = high_resolution_clock::now();
+  seq.compact();
+  t1 = high_resolution_clock::now();
+  cout << "compacted " << duration<double, milli>(t1 - t0).count() << " "
+       << traversal_msec(seq) << endl;
+  // a copy is sorted, and the array as built (never marked sorted) is
+  // traversed, since contains() binary searches a sorted array
+  ArraySeq<int> sorted = array;
+  t0 = high_resolution_clock::now();
+  sorted.merge_sort();
+  t1 = high_resolution_clock::now();
+  check_sorted(sorted);
+  cout << "array " << duration<double, milli>(t1 - t0).count() << " "
+       << traversal_msec(array) << endl;
+}
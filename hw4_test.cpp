@@ -5,11 +5,19 @@
 // DESC:
 //---------------------------------------------------------------------------
 
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <gtest/gtest.h>
 #include "linkedseq.h"
 #include "arrayseq.h"
+#include "searchindex.h"
+#include "unrolledseq.h"
+#include "util.h"
+#include "arenaseq.h"
 
 using namespace std;
 
@@ -634,6 +642,2076 @@ TEST(FourElemTests, LinkedSeqRandQuickSortCases)
     ASSERT_EQ(i * 10, seq3[i - 1]);
   }
 }
+//----------------------------------------------------------------------
+// ArraySeq Intro Sort Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqIntroSort)
+{
+  ArraySeq<int> seq;
+  seq.intro_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(BasicArraySeqTests, OneElemIntroSort)
+{
+  ArraySeq<int> seq;
+  seq.insert(10, 0);
+  seq.intro_sort();
+  ASSERT_EQ(1, seq.size());
+  ASSERT_EQ(10, seq[0]);
+}
+
+TEST(FourElemTests, ArraySeqIntroSortCases)
+{
+  ArraySeq<int> seq1; // <10,20,30,40>
+  ArraySeq<int> seq2; // <40,20,30,10>
+  ArraySeq<int> seq3; // <30,40,10,20>
+  seq1.insert(10, 0);
+  seq1.insert(20, 1);
+  seq1.insert(30, 2);
+  seq1.insert(40, 3);
+  seq2.insert(40, 0);
+  seq2.insert(20, 1);
+  seq2.insert(30, 2);
+  seq2.insert(10, 3);
+  seq3.insert(30, 0);
+  seq3.insert(40, 1);
+  seq3.insert(10, 2);
+  seq3.insert(20, 3);
+  seq1.intro_sort();
+  seq2.intro_sort();
+  seq3.intro_sort();
+  for (int i = 1; i <= 4; ++i)
+  {
+    ASSERT_EQ(i * 10, seq1[i - 1]);
+    ASSERT_EQ(i * 10, seq2[i - 1]);
+    ASSERT_EQ(i * 10, seq3[i - 1]);
+  }
+}
+
+TEST(LargeSeqTests, ArraySeqIntroSortReversedAndDuplicates)
+{
+  ArraySeq<int> seq1; // <1000,...,1>
+  ArraySeq<int> seq2; // <0,1,...,6,0,1,...>
+  for (int i = 0; i < 1000; ++i)
+  {
+    seq1.insert(1000 - i, i);
+    seq2.insert(i % 7, i);
+  }
+  seq1.intro_sort();
+  seq2.sort();
+  for (int i = 0; i < 1000; ++i)
+  {
+    ASSERT_EQ(i + 1, seq1[i]);
+  }
+  for (int i = 1; i < 1000; ++i)
+  {
+    ASSERT_LE(seq2[i - 1], seq2[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// ArraySeq Block Quick Sort Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqBlockQuickSort)
+{
+  ArraySeq<int> seq;
+  seq.block_quick_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(FourElemTests, ArraySeqBlockQuickSortCases)
+{
+  ArraySeq<int> seq1; // <10,20,30,40>
+  ArraySeq<int> seq2; // <40,20,30,10>
+  ArraySeq<int> seq3; // <30,40,10,20>
+  seq1.insert(10, 0);
+  seq1.insert(20, 1);
+  seq1.insert(30, 2);
+  seq1.insert(40, 3);
+  seq2.insert(40, 0);
+  seq2.insert(20, 1);
+  seq2.insert(30, 2);
+  seq2.insert(10, 3);
+  seq3.insert(30, 0);
+  seq3.insert(40, 1);
+  seq3.insert(10, 2);
+  seq3.insert(20, 3);
+  seq1.block_quick_sort();
+  seq2.block_quick_sort();
+  seq3.block_quick_sort();
+  for (int i = 1; i <= 4; ++i)
+  {
+    ASSERT_EQ(i * 10, seq1[i - 1]);
+    ASSERT_EQ(i * 10, seq2[i - 1]);
+    ASSERT_EQ(i * 10, seq3[i - 1]);
+  }
+}
+
+TEST(LargeSeqTests, ArraySeqBlockQuickSortPatterns)
+{
+  ArraySeq<int> seq1; // <5000,...,1>
+  ArraySeq<int> seq2; // organ pipe <0,1,...,2499,2500,...,1>
+  ArraySeq<int> seq3; // few unique values
+  for (int i = 0; i < 5000; ++i)
+  {
+    seq1.insert(5000 - i, i);
+    seq2.insert(i < 2500 ? i : 5000 - i, i);
+    seq3.insert((i * 7919) % 11, i);
+  }
+  seq1.block_quick_sort();
+  seq2.block_quick_sort();
+  seq3.block_quick_sort();
+  for (int i = 0; i < 5000; ++i)
+  {
+    ASSERT_EQ(i + 1, seq1[i]);
+  }
+  for (int i = 1; i < 5000; ++i)
+  {
+    ASSERT_LE(seq2[i - 1], seq2[i]);
+    ASSERT_LE(seq3[i - 1], seq3[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// ArraySeq Buffered Merge Sort Tests
+//----------------------------------------------------------------------
+
+// key/tag pair ordered by key only, for checking stability
+struct KeyTag
+{
+  int key;
+  int tag;
+};
+
+bool operator<(const KeyTag &lhs, const KeyTag &rhs)
+{
+  return lhs.key < rhs.key;
+}
+
+bool operator==(const KeyTag &lhs, const KeyTag &rhs)
+{
+  return lhs.key == rhs.key and lhs.tag == rhs.tag;
+}
+
+TEST(BasicArraySeqTests, EmptySeqBufferedMergeSort)
+{
+  ArraySeq<int> seq;
+  seq.buffered_merge_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(FourElemTests, ArraySeqBufferedMergeSortCases)
+{
+  ArraySeq<int> seq1; // <10,20,30,40>
+  ArraySeq<int> seq2; // <40,20,30,10>
+  ArraySeq<int> seq3; // <30,40,10,20>
+  seq1.insert(10, 0);
+  seq1.insert(20, 1);
+  seq1.insert(30, 2);
+  seq1.insert(40, 3);
+  seq2.insert(40, 0);
+  seq2.insert(20, 1);
+  seq2.insert(30, 2);
+  seq2.insert(10, 3);
+  seq3.insert(30, 0);
+  seq3.insert(40, 1);
+  seq3.insert(10, 2);
+  seq3.insert(20, 3);
+  seq1.buffered_merge_sort();
+  seq2.buffered_merge_sort();
+  seq3.buffered_merge_sort();
+  for (int i = 1; i <= 4; ++i)
+  {
+    ASSERT_EQ(i * 10, seq1[i - 1]);
+    ASSERT_EQ(i * 10, seq2[i - 1]);
+    ASSERT_EQ(i * 10, seq3[i - 1]);
+  }
+}
+
+TEST(LargeSeqTests, ArraySeqBufferedMergeSortScratchReuse)
+{
+  int scratch[1000];
+  ArraySeq<int> seq1; // <1000,...,1>
+  ArraySeq<int> seq2; // <1,3,5,...,2,4,6,...>
+  for (int i = 0; i < 1000; ++i)
+  {
+    seq1.insert(1000 - i, i);
+    seq2.insert(i < 500 ? 2 * i + 1 : 2 * (i - 500) + 2, i);
+  }
+  seq1.buffered_merge_sort(scratch, 1000);
+  seq2.buffered_merge_sort(scratch, 1000);
+  for (int i = 0; i < 1000; ++i)
+  {
+    ASSERT_EQ(i + 1, seq1[i]);
+    ASSERT_EQ(i + 1, seq2[i]);
+  }
+  ASSERT_THROW(seq1.buffered_merge_sort(scratch, 999), invalid_argument);
+}
+
+TEST(LargeSeqTests, ArraySeqBufferedMergeSortStable)
+{
+  ArraySeq<KeyTag> seq;
+  for (int i = 0; i < 500; ++i)
+  {
+    seq.insert(KeyTag{(i * 37) % 5, i}, i);
+  }
+  seq.buffered_merge_sort();
+  for (int i = 1; i < 500; ++i)
+  {
+    ASSERT_FALSE(seq[i].key < seq[i - 1].key);
+    if (seq[i].key == seq[i - 1].key)
+    {
+      ASSERT_LT(seq[i - 1].tag, seq[i].tag);
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// Bottom-Up Merge Sort Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqBottomUpMergeSort)
+{
+  ArraySeq<int> seq;
+  seq.bottom_up_merge_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(BasicLinkedSeqTests, EmptySeqBottomUpMergeSort)
+{
+  LinkedSeq<int> seq;
+  seq.bottom_up_merge_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(FourElemTests, LinkedSeqBottomUpMergeSortCases)
+{
+  LinkedSeq<int> seq1; // <10,20,30,40>
+  LinkedSeq<int> seq2; // <40,20,30,10>
+  LinkedSeq<int> seq3; // <30,40,10,20>
+  seq1.insert(10, 0);
+  seq1.insert(20, 1);
+  seq1.insert(30, 2);
+  seq1.insert(40, 3);
+  seq2.insert(40, 0);
+  seq2.insert(20, 1);
+  seq2.insert(30, 2);
+  seq2.insert(10, 3);
+  seq3.insert(30, 0);
+  seq3.insert(40, 1);
+  seq3.insert(10, 2);
+  seq3.insert(20, 3);
+  seq1.bottom_up_merge_sort();
+  seq2.bottom_up_merge_sort();
+  seq3.bottom_up_merge_sort();
+  for (int i = 1; i <= 4; ++i)
+  {
+    ASSERT_EQ(i * 10, seq1[i - 1]);
+    ASSERT_EQ(i * 10, seq2[i - 1]);
+    ASSERT_EQ(i * 10, seq3[i - 1]);
+  }
+  // tail is reset so appending still works
+  seq2.insert(50, 4);
+  ASSERT_EQ(50, seq2[4]);
+}
+
+TEST(LargeSeqTests, BottomUpMergeSortReversed)
+{
+  ArraySeq<int> seq1; // <1001,...,1>
+  LinkedSeq<int> seq2; // <1001,...,1>
+  for (int i = 0; i < 1001; ++i)
+  {
+    seq1.insert(1001 - i, i);
+    seq2.insert(1001 - i, i);
+  }
+  seq1.bottom_up_merge_sort();
+  seq2.bottom_up_merge_sort();
+  for (int i = 0; i < 1001; ++i)
+  {
+    ASSERT_EQ(i + 1, seq1[i]);
+    ASSERT_EQ(i + 1, seq2[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// Natural Merge Sort (Timsort) Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqTimSort)
+{
+  ArraySeq<int> seq;
+  seq.tim_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(BasicLinkedSeqTests, EmptySeqNaturalMergeSort)
+{
+  LinkedSeq<int> seq;
+  seq.natural_merge_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(FourElemTests, ArraySeqTimSortCases)
+{
+  ArraySeq<int> seq1; // <10,20,30,40>
+  ArraySeq<int> seq2; // <40,20,30,10>
+  ArraySeq<int> seq3; // <30,40,10,20>
+  seq1.insert(10, 0);
+  seq1.insert(20, 1);
+  seq1.insert(30, 2);
+  seq1.insert(40, 3);
+  seq2.insert(40, 0);
+  seq2.insert(20, 1);
+  seq2.insert(30, 2);
+  seq2.insert(10, 3);
+  seq3.insert(30, 0);
+  seq3.insert(40, 1);
+  seq3.insert(10, 2);
+  seq3.insert(20, 3);
+  seq1.tim_sort();
+  seq2.tim_sort();
+  seq3.tim_sort();
+  for (int i = 1; i <= 4; ++i)
+  {
+    ASSERT_EQ(i * 10, seq1[i - 1]);
+    ASSERT_EQ(i * 10, seq2[i - 1]);
+    ASSERT_EQ(i * 10, seq3[i - 1]);
+  }
+}
+
+TEST(FourElemTests, LinkedSeqNaturalMergeSortCases)
+{
+  LinkedSeq<int> seq1; // <10,20,30,40>
+  LinkedSeq<int> seq2; // <40,20,30,10>
+  LinkedSeq<int> seq3; // <30,40,10,20>
+  seq1.insert(10, 0);
+  seq1.insert(20, 1);
+  seq1.insert(30, 2);
+  seq1.insert(40, 3);
+  seq2.insert(40, 0);
+  seq2.insert(20, 1);
+  seq2.insert(30, 2);
+  seq2.insert(10, 3);
+  seq3.insert(30, 0);
+  seq3.insert(40, 1);
+  seq3.insert(10, 2);
+  seq3.insert(20, 3);
+  seq1.natural_merge_sort();
+  seq2.natural_merge_sort();
+  seq3.natural_merge_sort();
+  for (int i = 1; i <= 4; ++i)
+  {
+    ASSERT_EQ(i * 10, seq1[i - 1]);
+    ASSERT_EQ(i * 10, seq2[i - 1]);
+    ASSERT_EQ(i * 10, seq3[i - 1]);
+  }
+}
+
+TEST(LargeSeqTests, TimSortRunsAndStability)
+{
+  ArraySeq<KeyTag> seq1; // ascending and descending runs of keys
+  LinkedSeq<int> seq2;   // <2000,...,1>
+  for (int i = 0; i < 2000; ++i)
+  {
+    int block = i / 100;
+    int key = block % 2 == 0 ? i % 100 : 99 - i % 100;
+    seq1.insert(KeyTag{key / 3, i}, i);
+    seq2.insert(2000 - i, i);
+  }
+  seq1.tim_sort();
+  seq2.natural_merge_sort();
+  for (int i = 1; i < 2000; ++i)
+  {
+    ASSERT_FALSE(seq1[i].key < seq1[i - 1].key);
+    if (seq1[i].key == seq1[i - 1].key)
+    {
+      ASSERT_LT(seq1[i - 1].tag, seq1[i].tag);
+    }
+  }
+  for (int i = 0; i < 2000; ++i)
+  {
+    ASSERT_EQ(i + 1, seq2[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// ArraySeq Radix Sort Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqRadixSort)
+{
+  ArraySeq<int> seq;
+  seq.radix_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(FourElemTests, ArraySeqRadixSortNegatives)
+{
+  ArraySeq<int> seq; // <30,-40,0,-10>
+  seq.insert(30, 0);
+  seq.insert(-40, 1);
+  seq.insert(0, 2);
+  seq.insert(-10, 3);
+  seq.radix_sort();
+  ASSERT_EQ(-40, seq[0]);
+  ASSERT_EQ(-10, seq[1]);
+  ASSERT_EQ(0, seq[2]);
+  ASSERT_EQ(30, seq[3]);
+}
+
+TEST(LargeSeqTests, ArraySeqRadixSortIntegralTypes)
+{
+  ArraySeq<long long> seq1; // mixed sign, wide values
+  ArraySeq<unsigned char> seq2;
+  ArraySeq<int> seq3; // only the low byte differs
+  for (int i = 0; i < 3000; ++i)
+  {
+    long long wide = (i * 2654435761LL) % 1000003;
+    seq1.insert(i % 2 == 0 ? wide << 20 : -wide, i);
+    seq2.insert(static_cast<unsigned char>(i * 31), i);
+    seq3.insert(1000000 + (i * 7) % 256, i);
+  }
+  seq1.radix_sort();
+  seq2.radix_sort();
+  seq3.sort();
+  for (int i = 1; i < 3000; ++i)
+  {
+    ASSERT_LE(seq1[i - 1], seq1[i]);
+    ASSERT_LE(seq2[i - 1], seq2[i]);
+    ASSERT_LE(seq3[i - 1], seq3[i]);
+  }
+}
+
+TEST(LargeSeqTests, ArraySeqParallelRadixSort)
+{
+  ArraySeq<int> seq1; // pseudo-random, large enough to split
+  ArraySeq<int> seq2; // <10,-20,30>, falls back to radix_sort()
+  unsigned int x = 7;
+  for (int i = 0; i < 300000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    seq1.insert(static_cast<int>(x), i);
+  }
+  seq2.insert(10, 0);
+  seq2.insert(-20, 1);
+  seq2.insert(30, 2);
+  seq1.parallel_radix_sort(4);
+  seq2.parallel_radix_sort(0);
+  for (int i = 1; i < 300000; ++i)
+  {
+    ASSERT_LE(seq1[i - 1], seq1[i]);
+  }
+  ASSERT_EQ(-20, seq2[0]);
+  ASSERT_EQ(10, seq2[1]);
+  ASSERT_EQ(30, seq2[2]);
+}
+
+TEST(LargeSeqTests, ArraySeqParallelQuickSort)
+{
+  ArraySeq<int> seq1; // pseudo-random, large enough to split
+  ArraySeq<int> seq2; // few unique values
+  unsigned int x = 11;
+  for (int i = 0; i < 600000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    seq1.insert(static_cast<int>(x), i);
+    seq2.insert(static_cast<int>(x % 3), i);
+  }
+  seq1.parallel_quick_sort(4);
+  seq2.parallel_quick_sort(3);
+  for (int i = 1; i < 600000; ++i)
+  {
+    ASSERT_LE(seq1[i - 1], seq1[i]);
+    ASSERT_LE(seq2[i - 1], seq2[i]);
+  }
+}
+
+TEST(LargeSeqTests, ArraySeqParallelMergeSortStable)
+{
+  ArraySeq<KeyTag> seq;
+  unsigned int x = 13;
+  for (int i = 0; i < 100000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    seq.insert(KeyTag{static_cast<int>(x >> 20), i}, i);
+  }
+  seq.parallel_merge_sort(3);
+  for (int i = 1; i < 100000; ++i)
+  {
+    ASSERT_FALSE(seq[i].key < seq[i - 1].key);
+    if (seq[i].key == seq[i - 1].key)
+    {
+      ASSERT_LT(seq[i - 1].tag, seq[i].tag);
+    }
+  }
+}
+
+TEST(LargeSeqTests, ArraySeqParallelSampleSort)
+{
+  ArraySeq<int> seq1; // pseudo-random, large enough to split
+  ArraySeq<int> seq2; // few unique values, so splitters repeat
+  unsigned int x = 17;
+  for (int i = 0; i < 300000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    seq1.insert(static_cast<int>(x), i);
+    seq2.insert(static_cast<int>(x % 5), i);
+  }
+  seq1.parallel_sample_sort(4);
+  seq2.parallel_sample_sort(4);
+  for (int i = 1; i < 300000; ++i)
+  {
+    ASSERT_LE(seq1[i - 1], seq1[i]);
+    ASSERT_LE(seq2[i - 1], seq2[i]);
+  }
+  seq1.insert(0, 300000);
+  ASSERT_EQ(300001, seq1.size());
+}
+
+TEST(LargeSeqTests, ArraySeqParallelSampleSortFewUniqueKeys)
+{
+  // with 5 keys the sample repeats splitters, so every key lands in
+  // an equality bucket and no bucket is sorted again: beyond sampling,
+  // each element costs the tree walk (3 levels for 8 buckets) plus one
+  // equality check
+  ArraySeq<int> seq;
+  unsigned int x = 17;
+  for (int i = 0; i < 300000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    seq.insert(static_cast<int>((x >> 8) % 5), i);
+  }
+  std::atomic<long long> comparisons(0);
+  seq.parallel_sample_sort(4, [&](int a, int b) {
+    ++comparisons;
+    return a < b;
+  });
+  for (int i = 1; i < 300000; ++i)
+  {
+    ASSERT_LE(seq[i - 1], seq[i]);
+  }
+  ASSERT_LT(comparisons, 300000LL * 4 + 10000);
+}
+
+//----------------------------------------------------------------------
+// Three-Way Quick Sort Tests
+//----------------------------------------------------------------------
+
+TEST(BasicLinkedSeqTests, EmptySeqThreeWayQuickSort)
+{
+  LinkedSeq<int> seq;
+  seq.three_way_quick_sort();
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(FourElemTests, LinkedSeqThreeWayQuickSortCases)
+{
+  LinkedSeq<int> seq1; // <10,20,30,40>
+  LinkedSeq<int> seq2; // <40,20,30,10>
+  LinkedSeq<int> seq3; // <30,40,10,20>
+  seq1.insert(10, 0);
+  seq1.insert(20, 1);
+  seq1.insert(30, 2);
+  seq1.insert(40, 3);
+  seq2.insert(40, 0);
+  seq2.insert(20, 1);
+  seq2.insert(30, 2);
+  seq2.insert(10, 3);
+  seq3.insert(30, 0);
+  seq3.insert(40, 1);
+  seq3.insert(10, 2);
+  seq3.insert(20, 3);
+  seq1.three_way_quick_sort();
+  seq2.three_way_quick_sort();
+  seq3.three_way_quick_sort();
+  for (int i = 1; i <= 4; ++i)
+  {
+    ASSERT_EQ(i * 10, seq1[i - 1]);
+    ASSERT_EQ(i * 10, seq2[i - 1]);
+    ASSERT_EQ(i * 10, seq3[i - 1]);
+  }
+  // tail is kept so appending still works
+  seq3.insert(50, 4);
+  ASSERT_EQ(40, seq3[3]);
+  ASSERT_EQ(50, seq3[4]);
+}
+
+TEST(LargeSeqTests, ThreeWayQuickSortDuplicates)
+{
+  ArraySeq<int> seq1;  // all equal
+  ArraySeq<int> seq2;  // few unique values
+  LinkedSeq<int> seq3; // all equal
+  LinkedSeq<int> seq4; // few unique values
+  for (int i = 0; i < 3000; ++i)
+  {
+    seq1.insert(7, i);
+    seq2.insert((i * 7919) % 4, i);
+    seq3.insert(7, i);
+    seq4.insert((i * 7919) % 4, i);
+  }
+  seq1.three_way_quick_sort();
+  seq2.three_way_quick_sort();
+  seq3.three_way_quick_sort();
+  seq4.three_way_quick_sort();
+  for (int i = 0; i < 3000; ++i)
+  {
+    ASSERT_EQ(7, seq1[i]);
+    ASSERT_EQ(i / 750, seq2[i]);
+    ASSERT_EQ(7, seq3[i]);
+    ASSERT_EQ(i / 750, seq4[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// Dual-Pivot Quick Sort Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqDualPivotQuickSort)
+{
+  ArraySeq<int> seq;
+  seq.dual_pivot_quick_sort();
+  ASSERT_EQ(true, seq.empty());
+  seq.insert(10, 0);
+  seq.dual_pivot_quick_sort();
+  ASSERT_EQ(1, seq.size());
+  ASSERT_EQ(10, seq[0]);
+}
+
+TEST(LargeSeqTests, ArraySeqDualPivotQuickSortPatterns)
+{
+  ArraySeq<int> seq1; // reversed
+  ArraySeq<int> seq2; // shuffled
+  ArraySeq<int> seq3; // few unique values (equal pivots)
+  ArraySeq<int> seq4; // ascending then descending
+  for (int i = 0; i < 21000; ++i)
+  {
+    seq1.insert(21000 - i, i);
+    seq2.insert((int)((i * 2654435761u) % 21000) + 1, i);
+    seq3.insert((i * 7919) % 3, i);
+    seq4.insert(i < 10500 ? i : 21000 - i, i);
+  }
+  seq1.dual_pivot_quick_sort();
+  seq2.dual_pivot_quick_sort();
+  seq3.dual_pivot_quick_sort();
+  seq4.dual_pivot_quick_sort();
+  for (int i = 0; i < 21000; ++i)
+  {
+    ASSERT_EQ(i + 1, seq1[i]);
+    ASSERT_EQ(i / 7000, seq3[i]);
+  }
+  for (int i = 1; i < 21000; ++i)
+  {
+    ASSERT_LE(seq2[i - 1], seq2[i]);
+    ASSERT_LE(seq4[i - 1], seq4[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// Comparator and Projection Tests
+//----------------------------------------------------------------------
+
+// record ordered by id by default, sorted by timestamp in the tests
+struct Record
+{
+  int id;
+  int timestamp;
+};
+
+bool operator<(const Record &lhs, const Record &rhs)
+{
+  return lhs.id < rhs.id;
+}
+
+bool operator==(const Record &lhs, const Record &rhs)
+{
+  return lhs.id == rhs.id and lhs.timestamp == rhs.timestamp;
+}
+
+TEST(LargeSeqTests, ArraySeqSortsByProjectionAndComparator)
+{
+  ArraySeq<Record> records;
+  ArraySeq<int> ints;
+  for (int i = 0; i < 3000; ++i)
+  {
+    records.insert(Record{i, (i * 7919) % 3000}, i);
+    ints.insert((i * 7919) % 3000, i);
+  }
+  Record scratch[3000];
+  auto by_time = [](const Record &r) { return r.timestamp; };
+  function<void(ArraySeq<Record> &)> sorts[] = {
+      [](ArraySeq<Record> &s) { s.sort(less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.merge_sort(less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.quick_sort(less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.quick_sort_random(less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.dual_pivot_quick_sort(less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.intro_sort(less<>(), &Record::timestamp); },
+      [&](ArraySeq<Record> &s) { s.block_quick_sort(less<>(), by_time); },
+      [](ArraySeq<Record> &s) { s.buffered_merge_sort(less<>(), &Record::timestamp); },
+      [&](ArraySeq<Record> &s) { s.buffered_merge_sort(scratch, 3000, less<>(), by_time); },
+      [](ArraySeq<Record> &s) { s.bottom_up_merge_sort(less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.tim_sort(less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.radix_sort(&Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.parallel_radix_sort(2, &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.parallel_quick_sort(2, less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.parallel_merge_sort(2, less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.parallel_sample_sort(2, less<>(), &Record::timestamp); },
+      [](ArraySeq<Record> &s) { s.three_way_quick_sort(less<>(), &Record::timestamp); }};
+  for (auto &sort_fn : sorts)
+  {
+    ArraySeq<Record> seq = records;
+    sort_fn(seq);
+    for (int i = 0; i < 3000; ++i)
+    {
+      ASSERT_EQ(i, seq[i].timestamp);
+      ASSERT_EQ(i, (seq[i].id * 7919) % 3000);
+    }
+  }
+  // comparator only, largest first
+  ArraySeq<int> seq1 = ints;
+  ArraySeq<int> seq2 = ints;
+  seq1.sort(greater<>());
+  seq2.tim_sort([](int lhs, int rhs) { return lhs > rhs; });
+  for (int i = 0; i < 3000; ++i)
+  {
+    ASSERT_EQ(2999 - i, seq1[i]);
+    ASSERT_EQ(2999 - i, seq2[i]);
+  }
+}
+
+TEST(LargeSeqTests, LinkedSeqSortsByProjectionAndComparator)
+{
+  LinkedSeq<Record> records;
+  for (int i = 0; i < 3000; ++i)
+  {
+    records.insert(Record{i, (i * 7919) % 3000}, i);
+  }
+  function<void(LinkedSeq<Record> &)> sorts[] = {
+      [](LinkedSeq<Record> &s) { s.sort(greater<>(), &Record::timestamp); },
+      [](LinkedSeq<Record> &s) { s.merge_sort(greater<>(), &Record::timestamp); },
+      [](LinkedSeq<Record> &s) { s.quick_sort(greater<>(), &Record::timestamp); },
+      [](LinkedSeq<Record> &s) { s.quick_sort_random(greater<>(), &Record::timestamp); },
+      [](LinkedSeq<Record> &s) { s.bottom_up_merge_sort(greater<>(), &Record::timestamp); },
+      [](LinkedSeq<Record> &s) { s.natural_merge_sort(greater<>(), &Record::timestamp); },
+      [](LinkedSeq<Record> &s) { s.three_way_quick_sort(greater<>(), &Record::timestamp); }};
+  for (auto &sort_fn : sorts)
+  {
+    LinkedSeq<Record> seq = records;
+    sort_fn(seq);
+    for (int i = 0; i < 3000; ++i)
+    {
+      ASSERT_EQ(2999 - i, seq[i].timestamp);
+    }
+    // tail is kept so appending still works
+    seq.insert(Record{-1, -1}, 3000);
+    ASSERT_EQ(0, seq[2999].timestamp);
+    ASSERT_EQ(-1, seq[3000].timestamp);
+  }
+}
+
+TEST(LargeSeqTests, StableSortsByProjection)
+{
+  // sorting on timestamp / 100 leaves runs of 100 equal keys, which
+  // must keep their original (id) order
+  ArraySeq<Record> array_records;
+  LinkedSeq<Record> linked_records;
+  for (int i = 0; i < 3000; ++i)
+  {
+    array_records.insert(Record{i, (i * 7919) % 3000}, i);
+    linked_records.insert(Record{i, (i * 7919) % 3000}, i);
+  }
+  auto bucket = [](const Record &r) { return r.timestamp / 100; };
+  ArraySeq<Record> seq1 = array_records;
+  ArraySeq<Record> seq2 = array_records;
+  ArraySeq<Record> seq3 = array_records;
+  ArraySeq<Record> seq4 = array_records;
+  LinkedSeq<Record> seq5 = linked_records;
+  LinkedSeq<Record> seq6 = linked_records;
+  LinkedSeq<Record> seq7 = linked_records;
+  seq1.buffered_merge_sort(less<>(), bucket);
+  seq2.bottom_up_merge_sort(less<>(), bucket);
+  seq3.tim_sort(less<>(), bucket);
+  seq4.radix_sort(bucket);
+  seq5.merge_sort(less<>(), bucket);
+  seq6.bottom_up_merge_sort(less<>(), bucket);
+  seq7.natural_merge_sort(less<>(), bucket);
+  for (int i = 1; i < 3000; ++i)
+  {
+    ASSERT_LE(bucket(seq1[i - 1]), bucket(seq1[i]));
+    if (bucket(seq1[i - 1]) == bucket(seq1[i]))
+    {
+      ASSERT_LT(seq1[i - 1].id, seq1[i].id);
+    }
+    ASSERT_EQ(seq1[i], seq2[i]);
+    ASSERT_EQ(seq1[i], seq3[i]);
+    ASSERT_EQ(seq1[i], seq4[i]);
+    ASSERT_EQ(seq1[i], seq5[i]);
+    ASSERT_EQ(seq1[i], seq6[i]);
+    ASSERT_EQ(seq1[i], seq7[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// Argsort and Permutation Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqArgsort)
+{
+  ArraySeq<int> seq;
+  ArraySeq<int> order = seq.argsort();
+  ASSERT_EQ(true, order.empty());
+  seq.apply_permutation(order);
+  ASSERT_EQ(true, seq.empty());
+}
+
+TEST(FourElemTests, ArraySeqArgsortAndApplyPermutation)
+{
+  ArraySeq<int> seq; // <30,10,40,20>
+  seq.insert(30, 0);
+  seq.insert(10, 1);
+  seq.insert(40, 2);
+  seq.insert(20, 3);
+  ArraySeq<int> order = seq.argsort();
+  ASSERT_EQ(4, order.size());
+  ASSERT_EQ(1, order[0]);
+  ASSERT_EQ(3, order[1]);
+  ASSERT_EQ(0, order[2]);
+  ASSERT_EQ(2, order[3]);
+  // argsort leaves the elements where they are
+  ASSERT_EQ(30, seq[0]);
+  ASSERT_EQ(20, seq[3]);
+  ArraySeq<int> reversed = seq.argsort(greater<>());
+  ASSERT_EQ(2, reversed[0]);
+  ASSERT_EQ(0, reversed[1]);
+  ASSERT_EQ(3, reversed[2]);
+  ASSERT_EQ(1, reversed[3]);
+  seq.apply_permutation(order);
+  for (int i = 1; i <= 4; ++i)
+  {
+    ASSERT_EQ(i * 10, seq[i - 1]);
+  }
+  // not a permutation: wrong size, out of range, repeated index
+  ArraySeq<int> bad;
+  bad.insert(0, 0);
+  ASSERT_THROW(seq.apply_permutation(bad), std::invalid_argument);
+  bad.insert(1, 1);
+  bad.insert(2, 2);
+  bad.insert(4, 3);
+  ASSERT_THROW(seq.apply_permutation(bad), std::invalid_argument);
+  bad[3] = 2;
+  ASSERT_THROW(seq.apply_permutation(bad), std::invalid_argument);
+  ASSERT_EQ(10, seq[0]);
+  ASSERT_EQ(40, seq[3]);
+}
+
+TEST(FourElemTests, ArraySeqArgsortSetsSortedFlag)
+{
+  ArraySeq<int> seq; // <30,10,20>
+  seq.insert(30, 0);
+  seq.insert(10, 1);
+  seq.insert(20, 2);
+  // <1,2,0> is not sorted, so sort() must not return early and the
+  // searches must not binary search it
+  ArraySeq<int> order = seq.argsort();
+  ASSERT_EQ(false, order.is_sorted());
+  ASSERT_THROW(order.lower_bound(0), std::logic_error);
+  order.sort();
+  ASSERT_EQ(true, order.is_sorted());
+  for (int i = 0; i < 3; ++i)
+  {
+    ASSERT_EQ(i, order[i]);
+  }
+  // indexes of elements sorted by a non-arithmetic key
+  ArraySeq<string> words; // <"c","a","b">
+  words.insert("c", 0);
+  words.insert("a", 1);
+  words.insert("b", 2);
+  ArraySeq<int> word_order = words.argsort();
+  ASSERT_EQ(false, word_order.is_sorted());
+  // already sorted elements give the identity, which is sorted
+  seq.sort();
+  ArraySeq<int> identity = seq.argsort();
+  ASSERT_EQ(true, identity.is_sorted());
+  ASSERT_EQ(true, identity.contains(2));
+}
+
+TEST(LargeSeqTests, ArgsortStableByProjection)
+{
+  ArraySeq<Record> seq;
+  for (int i = 0; i < 3000; ++i)
+  {
+    seq.insert(Record{i, (i * 7919) % 3000}, i);
+  }
+  auto bucket = [](const Record &r) { return r.timestamp / 100; };
+  ArraySeq<int> order = seq.argsort(less<>(), bucket);
+  ArraySeq<Record> expected = seq;
+  expected.buffered_merge_sort(less<>(), bucket);
+  seq.apply_permutation(order);
+  for (int i = 0; i < 3000; ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+  }
+  // whole elements as keys (ordered by id) are compared in place
+  ArraySeq<int> by_id = expected.argsort();
+  for (int i = 0; i < 3000; ++i)
+  {
+    ASSERT_EQ(i, expected[by_id[i]].id);
+  }
+  // applying the inverse permutation puts everything back
+  ArraySeq<int> inverse = order;
+  for (int i = 0; i < 3000; ++i)
+  {
+    inverse[order[i]] = i;
+  }
+  seq.apply_permutation(inverse);
+  for (int i = 0; i < 3000; ++i)
+  {
+    ASSERT_EQ(i, seq[i].id);
+  }
+}
+
+//----------------------------------------------------------------------
+// Selection and Top-k Tests
+//----------------------------------------------------------------------
+
+TEST(FourElemTests, ArraySeqSelectPartialSortTopK)
+{
+  ArraySeq<int> seq; // <30,10,40,20>
+  seq.insert(30, 0);
+  seq.insert(10, 1);
+  seq.insert(40, 2);
+  seq.insert(20, 3);
+  LinkedSeq<int> top = seq.top_k(2);
+  ASSERT_EQ(2, top.size());
+  ASSERT_EQ(10, top[0]);
+  ASSERT_EQ(20, top[1]);
+  ASSERT_EQ(4, seq.top_k(10).size());
+  ASSERT_EQ(0, seq.top_k(0).size());
+  ASSERT_EQ(40, seq.top_k(1, greater<>())[0]);
+  // top_k leaves the elements where they are
+  ASSERT_EQ(30, seq[0]);
+  ASSERT_EQ(30, seq.select(2));
+  ASSERT_EQ(30, seq[2]);
+  ASSERT_EQ(40, seq[3]);
+  ASSERT_EQ(10, seq.select(0));
+  seq.partial_sort(4, greater<>());
+  ASSERT_EQ(40, seq[0]);
+  ASSERT_EQ(30, seq[1]);
+  ASSERT_EQ(20, seq[2]);
+  ASSERT_EQ(10, seq[3]);
+  ASSERT_THROW(seq.select(4), std::out_of_range);
+  ASSERT_THROW(seq.select(-1), std::out_of_range);
+  ASSERT_THROW(seq.partial_sort(5), std::out_of_range);
+  ASSERT_THROW(seq.top_k(-1), std::out_of_range);
+}
+
+TEST(LargeSeqTests, ArraySeqSelectPatterns)
+{
+  const int n = 5000;
+  ArraySeq<int> shuffled, reversed, duplicates, equal;
+  for (int i = 0; i < n; ++i)
+  {
+    shuffled.insert((i * 7919) % n, i);
+    reversed.insert(n - 1 - i, i);
+    duplicates.insert(i % 7, i);
+    equal.insert(5, i);
+  }
+  ArraySeq<int> inputs[] = {shuffled, reversed, duplicates, equal};
+  int ks[] = {0, 1, 17, n / 2, n - 2, n - 1};
+  for (auto &input : inputs)
+  {
+    ArraySeq<int> expected = input;
+    expected.sort();
+    for (int k : ks)
+    {
+      ArraySeq<int> seq = input;
+      ASSERT_EQ(expected[k], seq.select(k));
+      for (int i = 0; i < n; ++i)
+      {
+        ASSERT_EQ(true, i <= k ? seq[i] <= seq[k] : seq[k] <= seq[i]);
+      }
+      seq = input;
+      seq.partial_sort(k);
+      for (int i = 0; i < k; ++i)
+      {
+        ASSERT_EQ(expected[i], seq[i]);
+      }
+      LinkedSeq<int> top = input.top_k(k);
+      ASSERT_EQ(k, top.size());
+      for (int i = 0; i < k; ++i)
+      {
+        ASSERT_EQ(expected[i], top[i]);
+      }
+    }
+  }
+}
+
+TEST(LargeSeqTests, ArraySeqSelectByProjection)
+{
+  ArraySeq<Record> seq;
+  for (int i = 0; i < 3000; ++i)
+  {
+    seq.insert(Record{i, (i * 7919) % 3000}, i);
+  }
+  ASSERT_EQ(1500, seq.select(1500, less<>(), &Record::timestamp).timestamp);
+  LinkedSeq<Record> latest = seq.top_k(10, greater<>(), &Record::timestamp);
+  for (int i = 0; i < 10; ++i)
+  {
+    ASSERT_EQ(2999 - i, latest[i].timestamp);
+  }
+  seq.partial_sort(100, less<>(), &Record::timestamp);
+  for (int i = 0; i < 100; ++i)
+  {
+    ASSERT_EQ(i, seq[i].timestamp);
+  }
+}
+
+//----------------------------------------------------------------------
+// Sortedness Tracking and Binary Search Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqIsSorted)
+{
+  ArraySeq<int> seq;
+  ASSERT_EQ(true, seq.is_sorted());
+  ASSERT_EQ(false, seq.contains(10));
+  ASSERT_EQ(0, seq.lower_bound(10));
+  ASSERT_EQ(0, seq.upper_bound(10));
+  seq.insert(10, 0);
+  ASSERT_EQ(false, seq.is_sorted());
+  ASSERT_EQ(true, seq.verify_sorted());
+  seq.clear();
+  ASSERT_EQ(true, seq.is_sorted());
+}
+
+TEST(FourElemTests, ArraySeqSortedFlagUpdates)
+{
+  ArraySeq<int> seq; // <30,10,40,20>
+  seq.insert(30, 0);
+  seq.insert(10, 1);
+  seq.insert(40, 2);
+  seq.insert(20, 3);
+  ASSERT_EQ(false, seq.is_sorted());
+  ASSERT_EQ(false, seq.verify_sorted());
+  ASSERT_THROW(seq.lower_bound(20), std::logic_error);
+  seq.sort();
+  ASSERT_EQ(true, seq.is_sorted());
+  const ArraySeq<int> &view = seq;
+  ASSERT_EQ(10, view[0]);
+  ASSERT_EQ(true, seq.contains(40));
+  ASSERT_EQ(false, seq.contains(25));
+  // erasing keeps the order, inserting or writing does not
+  seq.erase(1);
+  ASSERT_EQ(true, seq.is_sorted());
+  seq.insert(20, 1);
+  ASSERT_EQ(false, seq.is_sorted());
+  seq.tim_sort();
+  ASSERT_EQ(true, seq.is_sorted());
+  seq[0] = 50;
+  ASSERT_EQ(false, seq.is_sorted());
+  ASSERT_EQ(true, seq.contains(50));
+  ASSERT_EQ(false, seq.verify_sorted());
+  // reverse order is not natural order
+  seq.merge_sort(greater<>());
+  ASSERT_EQ(false, seq.is_sorted());
+  seq.quick_sort();
+  ASSERT_EQ(true, seq.is_sorted());
+  ArraySeq<int> copy = seq;
+  ASSERT_EQ(true, copy.is_sorted());
+}
+
+TEST(LargeSeqTests, ArraySeqBinarySearchRanges)
+{
+  ArraySeq<int> seq;
+  for (int i = 0; i < 3000; ++i)
+  {
+    seq.insert((i * 7919) % 1000 * 2, i); // each even value < 2000, 3 times
+  }
+  seq.sort();
+  ASSERT_EQ(true, seq.is_sorted());
+  for (int v = -1; v <= 2000; ++v)
+  {
+    pair<int, int> range = seq.equal_range(v);
+    int expected = v < 0 ? 0 : v >= 2000 ? 3000 : (v + 1) / 2 * 3;
+    ASSERT_EQ(expected, seq.lower_bound(v));
+    ASSERT_EQ(expected, range.first);
+    bool present = v % 2 == 0 and v >= 0 and v < 2000;
+    ASSERT_EQ(present ? expected + 3 : expected, range.second);
+    ASSERT_EQ(present, seq.contains(v));
+  }
+  // sorting again is a no-op
+  seq.sort();
+  ASSERT_EQ(true, seq.is_sorted());
+  seq.partial_sort(10, greater<>());
+  ASSERT_EQ(false, seq.is_sorted());
+  seq.partial_sort(3000);
+  ASSERT_EQ(true, seq.is_sorted());
+}
+
+//----------------------------------------------------------------------
+// Search Index Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, EmptySeqSearchIndex)
+{
+  ArraySeq<int> seq;
+  SearchIndex<int> index(seq);
+  ASSERT_EQ(0, index.size());
+  ASSERT_EQ(false, index.contains(10));
+  ASSERT_EQ(0, index.lower_bound(10));
+  seq.insert(10, 0);
+  seq.insert(5, 1);
+  ASSERT_THROW(SearchIndex<int> unsorted(seq), std::logic_error);
+}
+
+TEST(LargeSeqTests, SearchIndexMatchesBinarySearch)
+{
+  // every size up to a few full levels, so each tree shape is covered
+  for (int n = 1; n <= 70; ++n)
+  {
+    ArraySeq<int> seq;
+    for (int i = 0; i < n; ++i)
+    {
+      seq.insert(2 * i, i);
+    }
+    seq.sort();
+    SearchIndex<int> index(seq);
+    ASSERT_EQ(n, index.size());
+    for (int v = -1; v <= 2 * n; ++v)
+    {
+      ASSERT_EQ(seq.lower_bound(v), index.lower_bound(v));
+      ASSERT_EQ(seq.contains(v), index.contains(v));
+    }
+  }
+  ArraySeq<string> words;
+  for (int i = 0; i < 3000; ++i)
+  {
+    words.insert(to_string((i * 7919) % 1000), i);
+  }
+  words.sort();
+  SearchIndex<string> moved = SearchIndex<string>(words);
+  for (int i = 0; i < 1000; ++i)
+  {
+    string key = to_string(i);
+    ASSERT_EQ(words.lower_bound(key), moved.lower_bound(key));
+    ASSERT_EQ(true, moved.contains(key));
+    ASSERT_EQ(false, moved.contains(key + "x0"));
+  }
+}
+
+//----------------------------------------------------------------------
+// Vectorized Scan Tests
+//----------------------------------------------------------------------
+
+template <typename T>
+void check_simd_find(SimdLevel level)
+{
+  // every length up to a few vector steps, with the key at every
+  // position, so each kernel's main loop and tail are covered
+  T data[40];
+  for (int n = 0; n <= 40; ++n)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      data[i] = static_cast<T>(i * 3 + 1);
+    }
+    ASSERT_EQ(-1, simd_find(data, n, static_cast<T>(2), level));
+    for (int at = 0; at < n; ++at)
+    {
+      ASSERT_EQ(at, simd_find(data, n, data[at], level));
+    }
+    if (n > 1)
+    {
+      // first of two matches
+      data[n - 1] = data[n / 2];
+      ASSERT_EQ(n / 2, simd_find(data, n, data[n / 2], level));
+    }
+  }
+}
+
+TEST(BasicArraySeqTests, SimdFindEveryLevel)
+{
+  SimdLevel levels[] = {SIMD_NONE, SIMD_SSE42, SIMD_AVX2};
+  for (SimdLevel level : levels)
+  {
+    check_simd_find<int>(level);
+    check_simd_find<float>(level);
+    check_simd_find<double>(level);
+  }
+  double values[] = {0.0, 1.5, -2.0};
+  ASSERT_EQ(0, simd_find(values, 3, -0.0));
+  ASSERT_EQ(-1, simd_find(values, 3, 0.0 / 0.0));
+}
+
+TEST(LargeSeqTests, ArraySeqVectorizedContains)
+{
+  ArraySeq<int> ints;
+  ArraySeq<float> floats;
+  ArraySeq<double> doubles;
+  for (int i = 0; i < 3000; ++i)
+  {
+    int value = (i * 7919) % 3000 * 2;
+    ints.insert(value, i);
+    floats.insert(value * 0.5f, i);
+    doubles.insert(value * 0.25, i);
+  }
+  ASSERT_EQ(false, ints.is_sorted());
+  for (int v = -1; v <= 6000; v += 7)
+  {
+    bool present = v >= 0 and v < 6000 and v % 2 == 0;
+    ASSERT_EQ(present, ints.contains(v));
+    ASSERT_EQ(present, floats.contains(v * 0.5f));
+    ASSERT_EQ(present, doubles.contains(v * 0.25));
+  }
+}
+
+//----------------------------------------------------------------------
+// ArraySeq Storage Tests
+//----------------------------------------------------------------------
+
+TEST(BasicArraySeqTests, ReserveAndShrinkToFit)
+{
+  ArraySeq<string> seq;
+  ASSERT_EQ(0, seq.storage_capacity());
+  seq.reserve(100);
+  ASSERT_EQ(100, seq.storage_capacity());
+  ASSERT_EQ(true, seq.empty());
+  for (int i = 0; i < 100; ++i)
+  {
+    seq.insert(to_string(i), i);
+  }
+  ASSERT_EQ(100, seq.storage_capacity());
+  seq.reserve(10);
+  ASSERT_EQ(100, seq.storage_capacity());
+  seq.insert("front", 0);
+  ASSERT_EQ(true, seq.storage_capacity() > 100);
+  seq.erase(50);
+  seq.shrink_to_fit();
+  ASSERT_EQ(100, seq.storage_capacity());
+  ASSERT_EQ("front", seq[0]);
+  ASSERT_EQ("48", seq[49]);
+  ASSERT_EQ("50", seq[50]);
+  ASSERT_EQ("99", seq[99]);
+  seq.clear();
+  ASSERT_EQ(0, seq.storage_capacity());
+}
+
+TEST(LargeSeqTests, ArraySeqGrowthFactor)
+{
+  ArraySeq<int> ints;
+  ArraySeq<string> strings;
+  ASSERT_THROW(ints.set_growth_factor(1.0), std::invalid_argument);
+  ints.set_growth_factor(1.5);
+  strings.set_growth_factor(1.25);
+  int grows = 0;
+  for (int i = 0; i < 5000; ++i)
+  {
+    int before = ints.storage_capacity();
+    ints.insert(i, i / 2); // middle inserts shift the tail
+    strings.insert(to_string(i), i / 2);
+    if (ints.storage_capacity() != before)
+    {
+      ASSERT_EQ(true, before == 0 or ints.storage_capacity() == int(before * 1.5));
+      ++grows;
+    }
+  }
+  ASSERT_EQ(true, grows < 20);
+  ArraySeq<int> copy = ints;
+  ASSERT_EQ(5000, copy.storage_capacity());
+  for (int i = 0; i < 5000; ++i)
+  {
+    ASSERT_EQ(ints[i], copy[i]);
+    ASSERT_EQ(to_string(ints[i]), strings[i]);
+  }
+}
+
+// int wrapper with no default constructor that counts how many are
+// alive, so an element destroyed twice or never shows up in the count
+struct LiveCounted
+{
+  static int live;
+  int value = 0;
+  LiveCounted(int v) : value(v) { ++live; }
+  LiveCounted(const LiveCounted &rhs) : value(rhs.value) { ++live; }
+  LiveCounted(LiveCounted &&rhs) : value(rhs.value) { ++live; }
+  LiveCounted &operator=(const LiveCounted &rhs) = default;
+  LiveCounted &operator=(LiveCounted &&rhs) = default;
+  ~LiveCounted() { --live; }
+  bool operator<(const LiveCounted &rhs) const { return value < rhs.value; }
+  bool operator==(const LiveCounted &rhs) const { return value == rhs.value; }
+};
+
+int LiveCounted::live = 0;
+
+TEST(LargeSeqTests, ArraySeqSortsNeedNoDefaultConstructor)
+{
+  // large enough for the parallel sorts to use two threads
+  const int n = 1 << 17;
+  {
+    ArraySeq<LiveCounted> base;
+    unsigned int x = 11;
+    for (int i = 0; i < n; ++i)
+    {
+      x = x * 1664525u + 1013904223u;
+      base.insert(LiveCounted(static_cast<int>(x >> 12)), i);
+    }
+    function<void(ArraySeq<LiveCounted> &)> sorts[] = {
+        [](ArraySeq<LiveCounted> &s) { s.merge_sort(); },
+        [](ArraySeq<LiveCounted> &s) { s.buffered_merge_sort(); },
+        [](ArraySeq<LiveCounted> &s) { s.bottom_up_merge_sort(); },
+        [](ArraySeq<LiveCounted> &s) { s.tim_sort(); },
+        [](ArraySeq<LiveCounted> &s) { s.radix_sort(&LiveCounted::value); },
+        [](ArraySeq<LiveCounted> &s) { s.parallel_radix_sort(2, &LiveCounted::value); },
+        [](ArraySeq<LiveCounted> &s) { s.parallel_merge_sort(2); },
+        [](ArraySeq<LiveCounted> &s) { s.parallel_sample_sort(2); },
+    };
+    for (auto &sort : sorts)
+    {
+      ArraySeq<LiveCounted> seq = base;
+      sort(seq);
+      ASSERT_EQ(2 * n, LiveCounted::live);
+      for (int i = 1; i < n; ++i)
+      {
+        ASSERT_EQ(false, seq[i] < seq[i - 1]);
+      }
+    }
+  }
+  ASSERT_EQ(0, LiveCounted::live);
+}
+
+//----------------------------------------------------------------------
+// LinkedSeq Node Allocator Tests
+//----------------------------------------------------------------------
+
+// string lists over each node allocator
+template <typename Seq>
+class LinkedSeqAllocatorTests : public testing::Test
+{
+};
+
+typedef testing::Types<LinkedSeq<string, HeapNodeAllocator>,
+                       LinkedSeq<string, PoolNodeAllocator>>
+    LinkedSeqAllocators;
+TYPED_TEST_SUITE(LinkedSeqAllocatorTests, LinkedSeqAllocators);
+
+TYPED_TEST(LinkedSeqAllocatorTests, NodeReuseLongStrings)
+{
+  // zero padded past the short string buffer, so a node reused before
+  // its string was destroyed, or freed twice, shows up
+  const string pad(40, '0');
+  TypeParam seq;
+  for (int i = 0; i < 1000; ++i)
+  {
+    seq.insert(pad + to_string((i * 7919) % 1000), i);
+  }
+  // freed nodes are reused, and erasing the last node moves the tail
+  string erased[200];
+  for (int i = 0; i < 100; ++i)
+  {
+    erased[2 * i] = seq[seq.size() - 1];
+    seq.erase(seq.size() - 1);
+    erased[2 * i + 1] = seq[0];
+    seq.erase(0);
+  }
+  ASSERT_EQ(800, seq.size());
+  seq.insert(pad + "end", 800);
+  ASSERT_EQ(pad + "end", seq[800]);
+  seq.erase(800);
+  for (int i = 0; i < 200; ++i)
+  {
+    seq.insert(erased[i], i % 2 == 0 ? seq.size() : 0);
+  }
+  TypeParam copy = seq;
+  copy.merge_sort(less<>(), [](const string &s) { return stoi(s); });
+  seq.clear();
+  ASSERT_EQ(true, seq.empty());
+  seq = std::move(copy);
+  ASSERT_EQ(1000, seq.size());
+  ASSERT_EQ(0, copy.size());
+  for (int i = 0; i < 1000; ++i)
+  {
+    ASSERT_EQ(pad + to_string(i), seq[i]);
+  }
+}
+
+TEST(LargeSeqTests, LinkedSeqNodeAllocators)
+{
+  LinkedSeq<int> ints;
+  for (int i = 0; i < 5000; ++i)
+  {
+    ints.insert(5000 - i, i);
+  }
+  ints.clear();
+  for (int i = 0; i < 100; ++i)
+  {
+    ints.insert(100 - i, i);
+  }
+  ints.quick_sort();
+  for (int i = 0; i < 100; ++i)
+  {
+    ASSERT_EQ(i + 1, ints[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// LinkedSeq Compaction Tests
+//----------------------------------------------------------------------
+
+TYPED_TEST(LinkedSeqAllocatorTests, CompactLongStrings)
+{
+  // zero padded past the short string buffer, so a value used after
+  // compact() moved it out shows up
+  const string pad(40, '0');
+  TypeParam seq;
+  seq.compact();
+  ASSERT_EQ(true, seq.empty());
+  for (int i = 0; i < 1000; ++i)
+  {
+    seq.insert(pad + to_string((i * 7919) % 1000), i / 2);
+  }
+  seq.merge_sort(less<>(), [](const string &s) { return stoi(s); });
+  seq.compact();
+  ASSERT_EQ(1000, seq.size());
+  for (int i = 0; i < 1000; ++i)
+  {
+    ASSERT_EQ(pad + to_string(i), seq[i]);
+  }
+  // the tail and the new storage are usable afterwards
+  seq.insert(pad + "1000", 1000);
+  ASSERT_EQ(pad + "1000", seq[1000]);
+  seq.erase(1000);
+  seq.erase(0);
+  ASSERT_EQ(pad + "1", seq[0]);
+  ASSERT_EQ(pad + "999", seq[998]);
+
+  seq.set_compact_after_sort(true);
+  seq.quick_sort(greater<>(), [](const string &s) { return stoi(s); });
+  ASSERT_EQ(pad + "999", seq[0]);
+  ASSERT_EQ(pad + "1", seq[998]);
+  seq.insert(pad + "0", 999);
+  ASSERT_EQ(pad + "0", seq[999]);
+}
+
+TEST(LargeSeqTests, LinkedSeqCompact)
+{
+  LinkedSeq<int> seq;
+  seq.set_compact_after_sort(true);
+  for (int i = 0; i < 100; ++i)
+  {
+    seq.insert(100 - i, i);
+  }
+  seq.three_way_quick_sort();
+  seq.insert(101, 100);
+  seq.natural_merge_sort();
+  for (int i = 0; i < 101; ++i)
+  {
+    ASSERT_EQ(i + 1, seq[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// LinkedSeq Finger Tests
+//----------------------------------------------------------------------
+
+TEST(LargeSeqTests, LinkedSeqFingerStaysValid)
+{
+  LinkedSeq<int> seq;
+  ArraySeq<int> expected;
+  for (int i = 0; i < 200; ++i)
+  {
+    seq.insert(i, i);
+    expected.insert(i, i);
+  }
+  // edits at, before and after the last index looked up
+  unsigned int x = 3;
+  for (int i = 0; i < 3000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    int at = (x >> 8) % expected.size();
+    ASSERT_EQ(expected[at], seq[at]);
+    int edit = (x >> 4) % expected.size();
+    if (x % 3 == 0)
+    {
+      seq.erase(edit);
+      expected.erase(edit);
+    }
+    else
+    {
+      seq.insert(i, edit);
+      expected.insert(i, edit);
+    }
+    const LinkedSeq<int> &view = seq;
+    ASSERT_EQ(expected[at % expected.size()], view[at % expected.size()]);
+  }
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+  }
+  // down to one node and back, then after a sort
+  while (seq.size() > 1)
+  {
+    seq[seq.size() - 2];
+    seq.erase(0);
+  }
+  seq.erase(0);
+  seq.insert(5, 0);
+  seq.insert(3, 1);
+  ASSERT_EQ(3, seq[1]);
+  seq.sort();
+  ASSERT_EQ(3, seq[0]);
+  ASSERT_EQ(5, seq[1]);
+}
+
+TEST(LargeSeqTests, LinkedSeqConstReadsFromThreads)
+{
+  LinkedSeq<int> seq;
+  for (int i = 0; i < 2000; ++i)
+  {
+    seq.insert(i, i);
+  }
+  seq[1000];
+  // const reads never move the finger, so threads can share them
+  const LinkedSeq<int> &view = seq;
+  long long sums[2] = {0, 0};
+  thread reader([&]() {
+    for (int i = 0; i < 2000; ++i)
+    {
+      sums[0] += view[i];
+    }
+  });
+  for (int i = 1999; i >= 0; --i)
+  {
+    sums[1] += view[i];
+  }
+  reader.join();
+  ASSERT_EQ(1999LL * 2000 / 2, sums[0]);
+  ASSERT_EQ(1999LL * 2000 / 2, sums[1]);
+  ASSERT_EQ(1000, seq[1000]);
+
+  ostringstream out;
+  LinkedSeq<int> three;
+  out << three;
+  ASSERT_EQ("", out.str());
+  for (int i = 0; i < 3; ++i)
+  {
+    three.insert(i, i);
+  }
+  out << three;
+  ASSERT_EQ("0, 1, 2", out.str());
+}
+
+TEST(LargeSeqTests, LinkedSeqSequentialIndexingIsLinear)
+{
+  // quadratic walks would take minutes at this size
+  LinkedSeq<int> seq;
+  for (int i = 0; i < 200000; ++i)
+  {
+    seq.insert(i, i);
+  }
+  long long sum = 0;
+  for (int i = 0; i < seq.size(); ++i)
+  {
+    sum += seq[i];
+  }
+  ASSERT_EQ(200000LL * 199999 / 2, sum);
+  for (int i = 0; i < seq.size(); i += 2)
+  {
+    seq.insert(-1, i);
+  }
+  ASSERT_EQ(400000, seq.size());
+  ASSERT_EQ(-1, seq[399998]);
+  ASSERT_EQ(199999, seq[399999]);
+}
+
+TEST(LargeSeqTests, LinkedSeqFaroShuffleIsLinear)
+{
+  // faro_shuffle() reads both halves of the list; a walk from head
+  // for every other read would take minutes at this size
+  LinkedSeq<int> seq;
+  ArraySeq<int> expected;
+  load_in_order(seq, 200000);
+  load_in_order(expected, 200000);
+  faro_shuffle(seq, 3);
+  faro_shuffle(expected, 3);
+  ASSERT_EQ(200000, seq.size());
+  for (int i = 0; i < 200000; ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+  }
+  // <1..6> out shuffled is <1,4,2,5,3,6>, then in shuffled
+  // <5,1,3,4,6,2>
+  LinkedSeq<int> small;
+  load_in_order(small, 6);
+  faro_shuffle(small, 1);
+  int out[] = {1, 4, 2, 5, 3, 6};
+  for (int i = 0; i < 6; ++i)
+  {
+    ASSERT_EQ(out[i], small[i]);
+  }
+  small.clear();
+  load_in_order(small, 6);
+  faro_shuffle(small, 2);
+  int out_in[] = {5, 1, 3, 4, 6, 2};
+  for (int i = 0; i < 6; ++i)
+  {
+    ASSERT_EQ(out_in[i], small[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// Unrolled Linked List Tests
+//----------------------------------------------------------------------
+
+TEST(BasicLinkedSeqTests, EmptyUnrolledSeq)
+{
+  UnrolledSeq<int> seq;
+  ASSERT_EQ(true, seq.empty());
+  ASSERT_EQ(0, seq.block_count());
+  seq.sort();
+  ASSERT_EQ(true, seq.empty());
+  ASSERT_EQ(false, seq.contains(1));
+  ASSERT_THROW(seq[0], out_of_range);
+  ASSERT_THROW(seq.erase(0), out_of_range);
+  ASSERT_THROW(seq.insert(1, 1), out_of_range);
+}
+
+TEST(LargeSeqTests, UnrolledSeqInsertErase)
+{
+  // random inserts and erases checked against an ArraySeq, so blocks
+  // are split, merged and emptied all over the list
+  UnrolledSeq<int> seq;
+  ArraySeq<int> expected;
+  unsigned int x = 7;
+  for (int i = 0; i < 4000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    int r = (x >> 8) % 1000;
+    if (expected.size() > 0 and r < (i < 2000 ? 300 : 700))
+    {
+      int at = r % expected.size();
+      seq.erase(at);
+      expected.erase(at);
+    }
+    else
+    {
+      int at = r < 850 ? (x >> 4) % (expected.size() + 1) : expected.size();
+      seq.insert(i, at);
+      expected.insert(i, at);
+    }
+    ASSERT_EQ(expected.size(), seq.size());
+  }
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+  }
+  // splits and merges keep at least two elements per block on average
+  ASSERT_LE(seq.block_count(), expected.size() / 2 + 1);
+
+  UnrolledSeq<int> copy = seq;
+  seq.clear();
+  ASSERT_EQ(0, seq.block_count());
+  seq = std::move(copy);
+  ASSERT_EQ(0, copy.size());
+  ASSERT_EQ(expected.size(), seq.size());
+  while (not seq.empty())
+  {
+    ASSERT_EQ(expected[0], seq[0]);
+    seq.erase(0);
+    expected.erase(0);
+  }
+  ASSERT_EQ(0, seq.block_count());
+  seq.insert(1, 0);
+  ASSERT_EQ(1, seq[0]);
+}
+
+TEST(LargeSeqTests, UnrolledSeqInsertEraseLongStrings)
+{
+  // strings too long for the short string buffer, so a slot that is
+  // used after it was destroyed or moved from shows up
+  const string pad(40, 'x');
+  UnrolledSeq<string, HeapNodeAllocator> seq;
+  ArraySeq<string> expected;
+  unsigned int x = 7;
+  for (int i = 0; i < 2000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    int r = (x >> 8) % 1000;
+    if (expected.size() > 0 and r < (i < 1000 ? 300 : 700))
+    {
+      int at = r % expected.size();
+      seq.erase(at);
+      expected.erase(at);
+    }
+    else
+    {
+      int at = (x >> 4) % (expected.size() + 1);
+      seq.insert(pad + to_string(i), at);
+      expected.insert(pad + to_string(i), at);
+    }
+  }
+  ASSERT_EQ(expected.size(), seq.size());
+  UnrolledSeq<string, HeapNodeAllocator> copy = seq;
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+    ASSERT_EQ(expected[i], copy[i]);
+  }
+  seq.clear();
+  ASSERT_EQ(0, seq.block_count());
+  seq = std::move(copy);
+  ASSERT_EQ(expected.size(), seq.size());
+  ASSERT_EQ(expected[0], seq[0]);
+}
+
+TEST(LargeSeqTests, UnrolledSeqMergeSort)
+{
+  for (int n : {1, 2, 11, 12, 13, 100, 5001})
+  {
+    UnrolledSeq<int> seq;
+    ArraySeq<int> expected;
+    for (int i = 0; i < n; ++i)
+    {
+      int val = (i * 7919) % 97;
+      // middle inserts leave half-full blocks behind
+      seq.insert(val, i % 3 == 0 ? i / 2 : i);
+      expected.insert(val, i % 3 == 0 ? i / 2 : i);
+    }
+    seq.sort();
+    expected.sort();
+    for (int i = 0; i < n; ++i)
+    {
+      ASSERT_EQ(expected[i], seq[i]);
+    }
+    seq.insert(1000, n);
+    ASSERT_EQ(1000, seq[n]);
+    seq.merge_sort(greater<>());
+    ASSERT_EQ(1000, seq[0]);
+  }
+  // stable by projection
+  UnrolledSeq<string> seq;
+  for (int i = 0; i < 1000; ++i)
+  {
+    seq.insert(to_string(i), i);
+  }
+  seq.merge_sort(less<>(), [](const string &s) { return s.size(); });
+  for (int i = 0; i < 1000; ++i)
+  {
+    ASSERT_EQ(to_string(i), seq[i]);
+  }
+}
+
+TEST(LargeSeqTests, UnrolledSeqMergeSortKeepsElementsAlive)
+{
+  {
+    UnrolledSeq<LiveCounted> seq;
+    for (int i = 0; i < 3001; ++i)
+    {
+      seq.insert(LiveCounted((i * 7919) % 997), i % 3 == 0 ? i / 2 : i);
+    }
+    ASSERT_EQ(3001, LiveCounted::live);
+    seq.sort();
+    ASSERT_EQ(3001, LiveCounted::live);
+    for (int i = 1; i < seq.size(); ++i)
+    {
+      ASSERT_EQ(false, seq[i] < seq[i - 1]);
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+      seq.erase((i * 31) % seq.size());
+    }
+    ASSERT_EQ(2001, LiveCounted::live);
+  }
+  ASSERT_EQ(0, LiveCounted::live);
+}
+
+TEST(LargeSeqTests, UnrolledSeqMergeSortLongStrings)
+{
+  // middle inserts leave partly full blocks, so merges end part way
+  // through a block and shift its rest down
+  const string pad(40, 'x');
+  UnrolledSeq<string> seq;
+  ArraySeq<string> expected;
+  for (int i = 0; i < 3001; ++i)
+  {
+    string val = pad + to_string((i * 7919) % 997);
+    seq.insert(val, i % 3 == 0 ? i / 2 : i);
+    expected.insert(val, i % 3 == 0 ? i / 2 : i);
+  }
+  seq.sort();
+  expected.sort();
+  ASSERT_EQ(expected.size(), seq.size());
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+  }
+  seq.merge_sort(greater<>());
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[expected.size() - 1 - i], seq[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// Arena Linked List Tests
+//----------------------------------------------------------------------
+
+TEST(BasicLinkedSeqTests, EmptyArenaSeq)
+{
+  ArenaSeq<int> seq;
+  ASSERT_EQ(true, seq.empty());
+  seq.merge_sort();
+  seq.quick_sort();
+  ArenaSeq<int> copy = seq;
+  ASSERT_EQ(true, copy.empty());
+  ASSERT_EQ(false, seq.contains(1));
+  ASSERT_THROW(seq[0], out_of_range);
+  ASSERT_THROW(seq.erase(0), out_of_range);
+  ASSERT_THROW(seq.insert(1, 1), out_of_range);
+}
+
+TEST(LargeSeqTests, ArenaSeqInsertErase)
+{
+  // random inserts and erases checked against an ArraySeq
+  ArenaSeq<int> seq;
+  ArraySeq<int> expected;
+  unsigned int x = 7;
+  for (int i = 0; i < 3000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    int r = (x >> 8) % 1000;
+    if (expected.size() > 0 and r < 300)
+    {
+      int at = r % expected.size();
+      seq.erase(at);
+      expected.erase(at);
+    }
+    else
+    {
+      int at = (x >> 4) % (expected.size() + 1);
+      seq.insert(i, at);
+      expected.insert(i, at);
+    }
+  }
+  ASSERT_EQ(expected.size(), seq.size());
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+  }
+  // erased nodes were reused, so the arena only grew to fit the
+  // largest the list has been
+  ASSERT_LE(seq.storage_capacity(), 2 * expected.size());
+
+  // ints copy by memcpy of the arena
+  ArenaSeq<int> copy = seq;
+  seq.clear();
+  ASSERT_EQ(0, seq.storage_capacity());
+  seq = std::move(copy);
+  ASSERT_EQ(0, copy.size());
+  ASSERT_EQ(expected.size(), seq.size());
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+  }
+  seq.insert(-1, seq.size());
+  ASSERT_EQ(-1, seq[seq.size() - 1]);
+}
+
+TEST(LargeSeqTests, ArenaSeqInsertEraseLongStrings)
+{
+  // strings too long for the short string buffer, so a value that is
+  // used after it was destroyed or moved from shows up
+  const string pad(40, 'x');
+  ArenaSeq<string> seq;
+  ArraySeq<string> expected;
+  unsigned int x = 7;
+  for (int i = 0; i < 3000; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    int r = (x >> 8) % 1000;
+    if (expected.size() > 0 and r < 300)
+    {
+      int at = r % expected.size();
+      seq.erase(at);
+      expected.erase(at);
+    }
+    else
+    {
+      int at = (x >> 4) % (expected.size() + 1);
+      seq.insert(pad + to_string(i), at);
+      expected.insert(pad + to_string(i), at);
+    }
+  }
+  // strings copy node by node and move their values when the arena
+  // grows
+  ArenaSeq<string> copy = seq;
+  ASSERT_EQ(expected.size(), seq.size());
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+    ASSERT_EQ(expected[i], copy[i]);
+  }
+  seq.clear();
+  ASSERT_EQ(0, seq.storage_capacity());
+  seq = std::move(copy);
+  ASSERT_EQ(0, copy.size());
+  ASSERT_EQ(expected.size(), seq.size());
+  ASSERT_EQ(expected[0], seq[0]);
+}
+
+TEST(LargeSeqTests, ArenaSeqSorts)
+{
+  ArenaSeq<int> seq;
+  ArraySeq<int> expected;
+  for (int i = 0; i < 3000; ++i)
+  {
+    int val = (i * 7919) % 1000;
+    seq.insert(val, i % 3 == 0 ? i / 2 : i);
+    expected.insert(val, i % 3 == 0 ? i / 2 : i);
+  }
+  ArenaSeq<int> copy = seq;
+  seq.quick_sort();
+  copy.merge_sort();
+  expected.sort();
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+    ASSERT_EQ(expected[i], copy[i]);
+  }
+  // the sorts leave tail on the last node
+  seq.insert(1000, seq.size());
+  ASSERT_EQ(1000, seq[seq.size() - 1]);
+  copy.merge_sort(greater<>());
+  ASSERT_EQ(expected[expected.size() - 1], copy[0]);
+  ASSERT_EQ(expected[0], copy[copy.size() - 1]);
+
+  ArenaSeq<int> ints;
+  ints.reserve(1000);
+  for (int i = 0; i < 1000; ++i)
+  {
+    ints.insert(1000 - i, i);
+  }
+  ASSERT_EQ(1000, ints.storage_capacity());
+  ASSERT_EQ(1000LL * 8, ints.memory_bytes());
+  ints.quick_sort();
+  for (int i = 0; i < 1000; ++i)
+  {
+    ASSERT_EQ(i + 1, ints[i]);
+  }
+}
+
+TEST(LargeSeqTests, ArenaSeqSortsLongStrings)
+{
+  const string pad(40, 'x');
+  ArenaSeq<string> seq;
+  ArraySeq<string> expected;
+  for (int i = 0; i < 3000; ++i)
+  {
+    string val = pad + to_string((i * 7919) % 1000);
+    seq.insert(val, i % 3 == 0 ? i / 2 : i);
+    expected.insert(val, i % 3 == 0 ? i / 2 : i);
+  }
+  ArenaSeq<string> copy = seq;
+  seq.quick_sort();
+  copy.merge_sort();
+  expected.sort();
+  for (int i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], seq[i]);
+    ASSERT_EQ(expected[i], copy[i]);
+  }
+  seq.quick_sort(greater<>());
+  ASSERT_EQ(expected[expected.size() - 1], seq[0]);
+  ASSERT_EQ(expected[0], seq[seq.size() - 1]);
+}
+
+//----------------------------------------------------------------------
+// Move-Aware Sort Tests
+//----------------------------------------------------------------------
+
+// string-backed element that counts how often it is copied
+struct CopyCounted
+{
+  static int copies;
+  string value;
+  CopyCounted() = default;
+  CopyCounted(const string &v) : value(v) {}
+  CopyCounted(const CopyCounted &rhs) : value(rhs.value) { ++copies; }
+  CopyCounted(CopyCounted &&rhs) = default;
+  CopyCounted &operator=(const CopyCounted &rhs)
+  {
+    ++copies;
+    value = rhs.value;
+    return *this;
+  }
+  CopyCounted &operator=(CopyCounted &&rhs) = default;
+};
+
+int CopyCounted::copies = 0;
+
+bool operator<(const CopyCounted &lhs, const CopyCounted &rhs)
+{
+  return lhs.value < rhs.value;
+}
+
+bool operator==(const CopyCounted &lhs, const CopyCounted &rhs)
+{
+  return lhs.value == rhs.value;
+}
+
+TEST(LargeSeqTests, SortsMoveInsteadOfCopy)
+{
+  ArraySeq<CopyCounted> array_base;
+  LinkedSeq<CopyCounted> linked_base;
+  for (int i = 0; i < 2000; ++i)
+  {
+    string key = to_string(100000 + (i * 7919) % 2000);
+    array_base.insert(CopyCounted(key), i);
+    linked_base.insert(CopyCounted(key), i);
+  }
+  ASSERT_EQ(0, CopyCounted::copies);
+  function<void(ArraySeq<CopyCounted> &)> array_sorts[] = {
+      [](ArraySeq<CopyCounted> &s) { s.merge_sort(); },
+      [](ArraySeq<CopyCounted> &s) { s.quick_sort(); },
+      [](ArraySeq<CopyCounted> &s) { s.quick_sort_random(); },
+      [](ArraySeq<CopyCounted> &s) { s.intro_sort(); },
+      [](ArraySeq<CopyCounted> &s) { s.block_quick_sort(); },
+      [](ArraySeq<CopyCounted> &s) { s.buffered_merge_sort(); },
+      [](ArraySeq<CopyCounted> &s) { s.bottom_up_merge_sort(); },
+      [](ArraySeq<CopyCounted> &s) { s.tim_sort(); },
+      [](ArraySeq<CopyCounted> &s) { s.dual_pivot_quick_sort(); }};
+  for (auto &sort_fn : array_sorts)
+  {
+    ArraySeq<CopyCounted> seq = array_base;
+    CopyCounted::copies = 0;
+    sort_fn(seq);
+    ASSERT_EQ(0, CopyCounted::copies);
+    for (int i = 0; i < 2000; ++i)
+    {
+      ASSERT_EQ(to_string(100000 + i), seq[i].value);
+    }
+  }
+  function<void(LinkedSeq<CopyCounted> &)> linked_sorts[] = {
+      [](LinkedSeq<CopyCounted> &s) { s.merge_sort(); },
+      [](LinkedSeq<CopyCounted> &s) { s.quick_sort(); },
+      [](LinkedSeq<CopyCounted> &s) { s.quick_sort_random(); },
+      [](LinkedSeq<CopyCounted> &s) { s.bottom_up_merge_sort(); },
+      [](LinkedSeq<CopyCounted> &s) { s.natural_merge_sort(); },
+      [](LinkedSeq<CopyCounted> &s) { s.three_way_quick_sort(); }};
+  for (auto &sort_fn : linked_sorts)
+  {
+    LinkedSeq<CopyCounted> seq = linked_base;
+    CopyCounted::copies = 0;
+    sort_fn(seq);
+    ASSERT_EQ(0, CopyCounted::copies);
+    for (int i = 0; i < 2000; ++i)
+    {
+      ASSERT_EQ(to_string(100000 + i), seq[i].value);
+    }
+  }
+}
+
 //----------------------------------------------------------------------
 // Main
 //----------------------------------------------------------------------
@@ -10,9 +10,14 @@
 
 #include <stdexcept>
 #include <ostream>
+#include <type_traits>
+#include <utility>
+#include "nodepool.h"
+#include "listsort.h"
 #include "sequence.h"
+#include "sortkey.h"
 
-template <typename T>
+template <typename T, template <typename> class NodeAlloc = PoolNodeAllocator>
 class LinkedSeq : public Sequence<T>
 {
 public:
@@ -40,21 +45,31 @@ public:
   // Tests if the sequence is empty
   bool empty() const override;
 
-  // Removes all of the elements from the sequence
+  // Removes all of the elements from the sequence. With a pooled
+  // NodeAlloc (the default, see nodepool.h) the node storage is
+  // released in bulk rather than node by node.
   void clear() override;
 
   // Returns a reference to the element at the index in the
-  // sequence. Throws out_of_range if index is invalid.
+  // sequence. Throws out_of_range if index is invalid. Walks on from
+  // the last index looked up when that is not past index, so looping
+  // over the indices in order is linear overall.
   T &operator[](int index) override;
 
   // Returns a constant address to the element at the index in the
-  // sequence. Throws out_of_range if index is invalid.
+  // sequence. Throws out_of_range if index is invalid. Walks on from
+  // the finger left by non-const access when it helps, but never
+  // moves it, so const reads from several threads are safe.
   const T &operator[](int index) const override;
 
   // Extends the sequence by inserting the element at the given
   // index. Throws out_of_range if the index is invalid.
   void insert(const T &elem, int index) override;
 
+  // Same as above, but moves the element into the new node instead of
+  // copying it
+  void insert(T &&elem, int index);
+
   // Shrinks the sequence by removing the element at the index in the
   // sequence. Throws out_of_range if index is invalid.
   void erase(int index) override;
@@ -67,16 +82,66 @@ public:
   // (<=) operator. Uses merge sort.
   void sort();
 
+  // Every sort below also takes an optional comparator and key
+  // projection (see sortkey.h) and orders elements a and b by
+  // comp(proj(a), proj(b)), e.g. sort(std::greater<>()) or
+  // natural_merge_sort(std::less<>(), &Record::timestamp).
+
+  // Same as sort() but ordered by comp and proj
+  template <typename Compare, typename Project = Identity>
+  void sort(Compare comp, Project proj = Project());
+
   // Sorts the sequence in place using the merge sort algorithm.
-  void merge_sort();
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void merge_sort(Compare comp = Compare(), Project proj = Project());
 
   // Sorts the sequence in place using the quick sort algorithm. Uses
   // first element for pivot values.
-  void quick_sort();
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void quick_sort(Compare comp = Compare(), Project proj = Project());
 
   // Sorts the sequence in place using the quick sort algorithm. Uses
   // randomly selected indexes for pivot values.
-  void quick_sort_random();
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void quick_sort_random(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using iterative (bottom-up) merge
+  // sort. Nodes are taken off the front one at a time and merged into
+  // bins holding sorted runs of length 1, 2, 4, ..., so no recursion
+  // or midpoint scans are needed. Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void bottom_up_merge_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using natural merge sort. Existing
+  // ascending and strictly descending runs are found (descending ones
+  // are relinked in reverse) and merged using Timsort's run stack
+  // rules, so sorted and reverse sorted input take O(n). Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void natural_merge_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Sorts the sequence in place using quick sort with three-way
+  // partitioning around the median of the first, quarter-way, and
+  // middle nodes' values. Nodes are split into
+  // less, equal, and greater lists, and the equal nodes are placed
+  // once and left out of the recursion, so all-equal and few-unique
+  // inputs take linear time. Recurses only into the shorter side.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void three_way_quick_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Moves the nodes into fresh storage in list order, so a traversal
+  // walks memory sequentially (with the default pooled NodeAlloc)
+  // instead of in allocation order. Values are moved, not copied, and
+  // references to elements are invalidated.
+  void compact();
+
+  // Makes every sort above finish with compact() when on. Off by
+  // default.
+  void set_compact_after_sort(bool on);
+
+  // Writes the elements separated by commas in one walk over the
+  // nodes
+  template <typename U, template <typename> class A>
+  friend std::ostream &operator<<(std::ostream &stream, const LinkedSeq<U, A> &seq);
 
 private:
   // linked list node
@@ -95,45 +160,97 @@ private:
   // size of list
   int node_count = 0;
 
-  // sort function helpers
-  Node *merge_sort(Node *left, int len);
-  Node *quick_sort(Node *start, int len);
-  Node *quick_sort_random(Node *start, int len);
+  // storage for the nodes
+  NodeAlloc<Node> nodes;
+
+  // builds a node holding elem in storage from nodes, and destroys
+  // and frees one
+  Node *make_node(T &&elem);
+  void free_node(Node *node);
+
+  // last node reached by index and its index (finger is null when
+  // unset). Lookups at or after it walk on from there instead of from
+  // head, so a loop over indices takes amortized O(1) per step.
+  // insert() and erase() keep it valid; sorts, compact() and clear()
+  // unset it. Only non-const access moves it, so concurrent const
+  // reads stay free of data races (they use it but never write it).
+  Node *finger = nullptr;
+  int finger_index = 0;
+
+  // returns the node at index, from the finger when it is at or
+  // before index; the non-const version moves the finger there
+  Node *node_at(int index);
+  Node *node_at(int index) const;
+
+  // link policy that lets the shared sorts in listsort.h relink
+  // nodes by pointer
+  struct NodeLinks
+  {
+    typedef Node *Link;
+    Link nil() const { return nullptr; }
+    Link next(Link node) const { return node->next; }
+    void set_next(Link node, Link next) const { node->next = next; }
+    const T &value(Link node) const { return node->value; }
+    void prefetch(Link node) const { __builtin_prefetch(node); }
+  };
+
+  // sort function helpers, less is the KeyLess ordering built from
+  // the caller's comparator and projection
+  template <typename Less>
+  Node *merge_sort(Node *left, int len, const Less &less);
+  template <typename Less>
+  Node *quick_sort(Node *start, int len, const Less &less);
+  template <typename Less>
+  Node *quick_sort_random(Node *start, int len, const Less &less);
+  template <typename Less>
+  Node *merge(Node *left, Node *right, const Less &less);
+
+  // natural_merge_sort() pending runs; Timsort's stack invariants
+  // keep run lengths growing faster than Fibonacci, so this covers
+  // any int length
+  static const int MAX_RUNS = 49;
+  template <typename Less>
+  void merge_run_at(Node **run_head, int *run_len, int &runs, int i,
+                    const Less &less);
 
   // random seed for quick sort
   int seed = 22;
+
+  // run compact() at the end of each sort
+  bool compact_after_sort = false;
 };
 
-template <typename T>
-std::ostream &operator<<(std::ostream &stream, const LinkedSeq<T> &seq)
+template <typename T, template <typename> class NodeAlloc>
+std::ostream &operator<<(std::ostream &stream, const LinkedSeq<T, NodeAlloc> &seq)
 {
-  int n = seq.size();
-  for (int i = 0; i < n - 1; ++i)
-    stream << seq[i] << ", ";
-  if (n > 0)
-    stream << seq[n - 1];
+  for (auto node = seq.head; node != nullptr; node = node->next)
+  {
+    stream << node->value;
+    if (node->next != nullptr)
+      stream << ", ";
+  }
   return stream;
 }
 
-template <typename T>
-LinkedSeq<T>::LinkedSeq()
+template <typename T, template <typename> class NodeAlloc>
+LinkedSeq<T, NodeAlloc>::LinkedSeq()
 {
 }
 
-template <typename T>
-LinkedSeq<T>::LinkedSeq(const LinkedSeq<T> &rhs)
+template <typename T, template <typename> class NodeAlloc>
+LinkedSeq<T, NodeAlloc>::LinkedSeq(const LinkedSeq &rhs)
 {
   *this = rhs;
 }
 
-template <typename T>
-LinkedSeq<T>::LinkedSeq(LinkedSeq<T> &&rhs)
+template <typename T, template <typename> class NodeAlloc>
+LinkedSeq<T, NodeAlloc>::LinkedSeq(LinkedSeq &&rhs)
 {
   *this = std::move(rhs);
 }
 
-template <typename T>
-LinkedSeq<T> &LinkedSeq<T>::operator=(const LinkedSeq<T> &rhs)
+template <typename T, template <typename> class NodeAlloc>
+LinkedSeq<T, NodeAlloc> &LinkedSeq<T, NodeAlloc>::operator=(const LinkedSeq &rhs)
 {
   if (this != &rhs)
   {
@@ -148,8 +265,8 @@ LinkedSeq<T> &LinkedSeq<T>::operator=(const LinkedSeq<T> &rhs)
   return *this;
 }
 
-template <typename T>
-LinkedSeq<T> &LinkedSeq<T>::operator=(LinkedSeq<T> &&rhs)
+template <typename T, template <typename> class NodeAlloc>
+LinkedSeq<T, NodeAlloc> &LinkedSeq<T, NodeAlloc>::operator=(LinkedSeq &&rhs)
 {
   if (this != &rhs)
   {
@@ -157,22 +274,24 @@ LinkedSeq<T> &LinkedSeq<T>::operator=(LinkedSeq<T> &&rhs)
     head = rhs.head;
     tail = rhs.tail;
     node_count = rhs.node_count;
+    nodes = std::move(rhs.nodes);
 
     rhs.head = nullptr;
     rhs.tail = nullptr;
+    rhs.finger = nullptr;
     rhs.node_count = 0;
   }
   return *this;
 }
 
-template <typename T>
-LinkedSeq<T>::~LinkedSeq()
+template <typename T, template <typename> class NodeAlloc>
+LinkedSeq<T, NodeAlloc>::~LinkedSeq()
 {
   clear();
 }
 
-template <typename T>
-bool LinkedSeq<T>::empty() const
+template <typename T, template <typename> class NodeAlloc>
+bool LinkedSeq<T, NodeAlloc>::empty() const
 {
   if (head == nullptr)
   {
@@ -181,25 +300,117 @@ bool LinkedSeq<T>::empty() const
   return false;
 }
 
-template <typename T>
-void LinkedSeq<T>::clear()
+template <typename T, template <typename> class NodeAlloc>
+void LinkedSeq<T, NodeAlloc>::clear()
 {
-  Node *temp = head;
-  Node *nextPtr = nullptr;
-
-  while (temp != nullptr)
+  // a pool frees its nodes in bulk, so only values with destructors
+  // need the walk
+  if constexpr (not std::is_trivially_destructible<T>::value or
+                not NodeAlloc<Node>::BULK_RELEASE)
   {
-    nextPtr = temp->next;
-    delete temp;
-    temp = nextPtr;
-    node_count--;
+    Node *temp = head;
+    Node *nextPtr = nullptr;
+
+    while (temp != nullptr)
+    {
+      nextPtr = temp->next;
+      free_node(temp);
+      temp = nextPtr;
+    }
   }
+  nodes.release();
   head = nullptr;
   tail = nullptr;
+  finger = nullptr;
+  node_count = 0;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+typename LinkedSeq<T, NodeAlloc>::Node *LinkedSeq<T, NodeAlloc>::make_node(T &&elem)
+{
+  return new (nodes.allocate()) Node{std::move(elem), nullptr};
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void LinkedSeq<T, NodeAlloc>::free_node(Node *node)
+{
+  node->~Node();
+  nodes.deallocate(node);
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void LinkedSeq<T, NodeAlloc>::compact()
+{
+  // build the whole new list before freeing any old node, or the heap
+  // allocator would hand the freed node straight back
+  NodeAlloc<Node> fresh;
+  Node *front = nullptr;
+  Node *end = nullptr;
+  for (Node *old = head; old != nullptr; old = old->next)
+  {
+    Node *node = new (fresh.allocate()) Node{std::move(old->value), nullptr};
+    if (front == nullptr)
+    {
+      front = node;
+    }
+    else
+    {
+      end->next = node;
+    }
+    end = node;
+  }
+
+  if constexpr (not std::is_trivially_destructible<T>::value or
+                not NodeAlloc<Node>::BULK_RELEASE)
+  {
+    Node *old = head;
+    while (old != nullptr)
+    {
+      Node *next = old->next;
+      free_node(old);
+      old = next;
+    }
+  }
+  nodes = std::move(fresh);
+  head = front;
+  tail = end;
+  finger = nullptr;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void LinkedSeq<T, NodeAlloc>::set_compact_after_sort(bool on)
+{
+  compact_after_sort = on;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+typename LinkedSeq<T, NodeAlloc>::Node *LinkedSeq<T, NodeAlloc>::node_at(int index)
+{
+  Node *currNode = std::as_const(*this).node_at(index);
+  finger = currNode;
+  finger_index = index;
+  return currNode;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+typename LinkedSeq<T, NodeAlloc>::Node *LinkedSeq<T, NodeAlloc>::node_at(int index) const
+{
+  Node *currNode = head;
+  int i = 0;
+  if (finger != nullptr and finger_index <= index)
+  {
+    currNode = finger;
+    i = finger_index;
+  }
+  for (; i < index; ++i)
+  {
+    currNode = currNode->next;
+  }
+  return currNode;
 }
 
-template <typename T>
-T &LinkedSeq<T>::operator[](int index)
+template <typename T, template <typename> class NodeAlloc>
+T &LinkedSeq<T, NodeAlloc>::operator[](int index)
 {
   Node *update = nullptr;
   if (index < 0 || index >= size())
@@ -212,18 +423,13 @@ T &LinkedSeq<T>::operator[](int index)
   }
   else
   {
-    Node *currNode = head;
-    for (int i = 0; i < index; ++i)
-    {
-      currNode = currNode->next;
-    }
-    update = currNode;
+    update = node_at(index);
   }
   return update->value;
 }
 
-template <typename T>
-const T &LinkedSeq<T>::operator[](int index) const
+template <typename T, template <typename> class NodeAlloc>
+const T &LinkedSeq<T, NodeAlloc>::operator[](int index) const
 {
   Node *nodePtr = nullptr;
   if (index < 0 || index >= size())
@@ -236,26 +442,26 @@ const T &LinkedSeq<T>::operator[](int index) const
   }
   else
   {
-    Node *currNode = head;
-    for (int i = 0; i < index; ++i)
-    {
-      currNode = currNode->next;
-    }
-    nodePtr = currNode;
+    nodePtr = node_at(index);
   }
   return nodePtr->value;
 }
 
-template <typename T>
-void LinkedSeq<T>::insert(const T &elem, int index)
+template <typename T, template <typename> class NodeAlloc>
+void LinkedSeq<T, NodeAlloc>::insert(const T &elem, int index)
+{
+  insert(T(elem), index);
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void LinkedSeq<T, NodeAlloc>::insert(T &&elem, int index)
 {
   if (index < 0 || index > size())
   {
     throw std::out_of_range("Invalid index");
   }
 
-  Node *newnode = new Node;
-  newnode->value = elem;
+  Node *newnode = make_node(std::move(elem));
   if (empty()) // List is empty
   {
     head = newnode;
@@ -267,6 +473,7 @@ void LinkedSeq<T>::insert(const T &elem, int index)
     newnode->next = head;
     head = newnode;
     ++node_count;
+    ++finger_index;
   }
   else if (index == size()) // Add to the end of the list
   {
@@ -274,21 +481,17 @@ void LinkedSeq<T>::insert(const T &elem, int index)
     tail = newnode;
     ++node_count;
   }
-  else // Add node at certain index
+  else // Add node at certain index, the finger stays before it
   {
-    Node *currNode = head;
-    for (int i = 0; i < index - 1; ++i)
-    {
-      currNode = currNode->next;
-    }
+    Node *currNode = node_at(index - 1);
     newnode->next = currNode->next;
     currNode->next = newnode;
     ++node_count;
   }
 }
 
-template <typename T>
-void LinkedSeq<T>::erase(int index)
+template <typename T, template <typename> class NodeAlloc>
+void LinkedSeq<T, NodeAlloc>::erase(int index)
 {
   Node *traverseNode = head;
   Node *removeNode = nullptr;
@@ -301,24 +504,34 @@ void LinkedSeq<T>::erase(int index)
   {
     removeNode = head;
     head = removeNode->next;
-    delete removeNode;
+    if (removeNode == finger)
+    {
+      finger = nullptr;
+    }
+    --finger_index;
+    if (removeNode == tail)
+    {
+      tail = nullptr;
+    }
+    free_node(removeNode);
     node_count--;
   }
-  else
+  else // the finger stays before the removed node
   {
-    for (int i = 0; i < index - 1; ++i)
-    {
-      traverseNode = traverseNode->next;
-    }
+    traverseNode = node_at(index - 1);
     removeNode = traverseNode->next;
     traverseNode->next = removeNode->next;
-    delete removeNode;
+    if (removeNode == tail)
+    {
+      tail = traverseNode;
+    }
+    free_node(removeNode);
     node_count--;
   }
 }
 
-template <typename T>
-bool LinkedSeq<T>::contains(const T &elem) const
+template <typename T, template <typename> class NodeAlloc>
+bool LinkedSeq<T, NodeAlloc>::contains(const T &elem) const
 {
   Node *traverseNode = head;
   if (empty())
@@ -339,23 +552,32 @@ bool LinkedSeq<T>::contains(const T &elem) const
   return false;
 }
 
-template <typename T>
-int LinkedSeq<T>::size() const
+template <typename T, template <typename> class NodeAlloc>
+int LinkedSeq<T, NodeAlloc>::size() const
 {
   return node_count;
 }
 
 // Helper Functions
-template <typename T>
-void LinkedSeq<T>::sort()
+template <typename T, template <typename> class NodeAlloc>
+void LinkedSeq<T, NodeAlloc>::sort()
 {
   merge_sort();
 }
 
-template <typename T>
-void LinkedSeq<T>::merge_sort()
+template <typename T, template <typename> class NodeAlloc>
+template <typename Compare, typename Project>
+void LinkedSeq<T, NodeAlloc>::sort(Compare comp, Project proj)
+{
+  merge_sort(comp, proj);
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Compare, typename Project>
+void LinkedSeq<T, NodeAlloc>::merge_sort(Compare comp, Project proj)
 {
-  head = merge_sort(head, size());
+  KeyLess<Compare, Project> less(comp, proj);
+  head = merge_sort(head, size(), less);
 
   if (head == nullptr)
   {
@@ -370,12 +592,19 @@ void LinkedSeq<T>::merge_sort()
     }
     tail = traverse;
   }
+  finger = nullptr;
+  if (compact_after_sort)
+  {
+    compact();
+  }
 }
 
-template <typename T>
-void LinkedSeq<T>::quick_sort()
+template <typename T, template <typename> class NodeAlloc>
+template <typename Compare, typename Project>
+void LinkedSeq<T, NodeAlloc>::bottom_up_merge_sort(Compare comp, Project proj)
 {
-  head = quick_sort(head, size());
+  KeyLess<Compare, Project> less(comp, proj);
+  head = list_bottom_up_merge_sort(NodeLinks(), head, less);
 
   if (head == nullptr)
   {
@@ -390,13 +619,175 @@ void LinkedSeq<T>::quick_sort()
     }
     tail = traverse;
   }
+  finger = nullptr;
+  if (compact_after_sort)
+  {
+    compact();
+  }
 }
 
-template <typename T>
-void LinkedSeq<T>::quick_sort_random()
+template <typename T, template <typename> class NodeAlloc>
+template <typename Compare, typename Project>
+void LinkedSeq<T, NodeAlloc>::natural_merge_sort(Compare comp, Project proj)
 {
+  KeyLess<Compare, Project> less(comp, proj);
+  Node *run_head[MAX_RUNS];
+  int run_len[MAX_RUNS];
+  int runs = 0;
+
+  Node *rest = head;
+  while (rest != nullptr)
+  {
+    // cut the next run off the front of the list
+    Node *run = rest;
+    Node *last = rest;
+    int len = 1;
+    rest = rest->next;
+    if (rest != nullptr and less(rest->value, run->value))
+    {
+      // strictly descending, relink in reverse as it is read
+      last->next = nullptr;
+      while (rest != nullptr and less(rest->value, run->value))
+      {
+        Node *hold = rest->next;
+        rest->next = run;
+        run = rest;
+        rest = hold;
+        ++len;
+      }
+    }
+    else
+    {
+      while (rest != nullptr and not less(rest->value, last->value))
+      {
+        last = rest;
+        rest = rest->next;
+        ++len;
+      }
+      last->next = nullptr;
+    }
+    run_head[runs] = run;
+    run_len[runs] = len;
+    ++runs;
+
+    // keep run_len[i-2] > run_len[i-1] + run_len[i] and
+    // run_len[i-1] > run_len[i]
+    while (runs > 1)
+    {
+      int n = runs - 2;
+      if ((n > 0 and run_len[n - 1] <= run_len[n] + run_len[n + 1]) or
+          (n > 1 and run_len[n - 2] <= run_len[n] + run_len[n - 1]))
+      {
+        if (run_len[n - 1] < run_len[n + 1])
+        {
+          --n;
+        }
+      }
+      else if (run_len[n] > run_len[n + 1])
+      {
+        break;
+      }
+      merge_run_at(run_head, run_len, runs, n, less);
+    }
+  }
+
+  while (runs > 1)
+  {
+    int n = runs - 2;
+    if (n > 0 and run_len[n - 1] < run_len[n + 1])
+    {
+      --n;
+    }
+    merge_run_at(run_head, run_len, runs, n, less);
+  }
+  head = runs == 0 ? nullptr : run_head[0];
+
+  if (head == nullptr)
+  {
+    tail = head;
+  }
+  else
+  {
+    Node *traverse = head;
+    while (traverse->next != nullptr)
+    {
+      traverse = traverse->next;
+    }
+    tail = traverse;
+  }
+  finger = nullptr;
+  if (compact_after_sort)
+  {
+    compact();
+  }
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Less>
+void
+LinkedSeq<T, NodeAlloc>::merge_run_at(Node **run_head, int *run_len, int &runs, int i,
+                                      const Less &less)
+{
+  // merges runs i and i+1, shifting run i+2 down if there is one
+  run_head[i] = merge(run_head[i], run_head[i + 1], less);
+  run_len[i] = run_len[i] + run_len[i + 1];
+  if (i == runs - 3)
+  {
+    run_head[i + 1] = run_head[i + 2];
+    run_len[i + 1] = run_len[i + 2];
+  }
+  --runs;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Compare, typename Project>
+void LinkedSeq<T, NodeAlloc>::quick_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  head = quick_sort(head, size(), less);
+
+  if (head == nullptr)
+  {
+    tail = head;
+  }
+  else
+  {
+    Node *traverse = head;
+    while (traverse->next != nullptr)
+    {
+      traverse = traverse->next;
+    }
+    tail = traverse;
+  }
+  finger = nullptr;
+  if (compact_after_sort)
+  {
+    compact();
+  }
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Compare, typename Project>
+void LinkedSeq<T, NodeAlloc>::three_way_quick_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  Node *last = nullptr;
+  head = list_three_way_quick_sort(NodeLinks(), head, size(), last, less);
+  tail = last;
+  finger = nullptr;
+  if (compact_after_sort)
+  {
+    compact();
+  }
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Compare, typename Project>
+void LinkedSeq<T, NodeAlloc>::quick_sort_random(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
   std::srand(seed);
-  head = quick_sort_random(head, size());
+  head = quick_sort_random(head, size(), less);
 
   if (head == nullptr)
   {
@@ -411,10 +802,17 @@ void LinkedSeq<T>::quick_sort_random()
     }
     tail = traverse;
   }
+  finger = nullptr;
+  if (compact_after_sort)
+  {
+    compact();
+  }
 }
 
-template <typename T>
-typename LinkedSeq<T>::Node *LinkedSeq<T>::merge_sort(Node *left, int len)
+template <typename T, template <typename> class NodeAlloc>
+template <typename Less>
+typename LinkedSeq<T, NodeAlloc>::Node *
+LinkedSeq<T, NodeAlloc>::merge_sort(Node *left, int len, const Less &less)
 {
   int mid = 0;
   if (len <= 1)
@@ -433,71 +831,25 @@ typename LinkedSeq<T>::Node *LinkedSeq<T>::merge_sort(Node *left, int len)
     right = traverse->next;
     traverse->next = nullptr;
 
-    left = merge_sort(left, mid);
-    right = merge_sort(right, (len - mid));
+    left = merge_sort(left, mid, less);
+    right = merge_sort(right, (len - mid), less);
 
-    Node *front = nullptr;
-    Node *end = nullptr;
-
-    if (!left) // left is empty
-    {
-      return right;
-    }
-    else if (!right) // right is empty
-    {
-      return left;
-    }
-
-    // setting a head pointer
-    if (left->value <= right->value)
-    {
-      front = left;
-      left = left->next;
-    }
-    else
-    {
-      front = right;
-      right = right->next;
-    }
-    // setting a tail pointer
-    end = front;
-
-    // traversing list and comparing
-    while (left and right)
-    {
-      Node *hold = nullptr;
-
-      if (left->value <= right->value)
-      {
-        hold = left;
-        left = left->next;
-      }
-      else
-      {
-        hold = right;
-        right = right->next;
-      }
-
-      end->next = hold;
-      end = end->next;
-    }
-
-    // Add to end if necessary
-    if (left)
-    {
-      end->next = left;
-    }
-    else if (right)
-    {
-      end->next = right;
-    }
-
-    return front;
+    return merge(left, right, less);
   }
 }
 
-template <typename T>
-typename LinkedSeq<T>::Node *LinkedSeq<T>::quick_sort(Node *start, int len)
+template <typename T, template <typename> class NodeAlloc>
+template <typename Less>
+typename LinkedSeq<T, NodeAlloc>::Node *
+LinkedSeq<T, NodeAlloc>::merge(Node *left, Node *right, const Less &less)
+{
+  return list_merge(NodeLinks(), left, right, less);
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Less>
+typename LinkedSeq<T, NodeAlloc>::Node *
+LinkedSeq<T, NodeAlloc>::quick_sort(Node *start, int len, const Less &less)
 {
   if (len <= 1)
   {
@@ -521,7 +873,7 @@ typename LinkedSeq<T>::Node *LinkedSeq<T>::quick_sort(Node *start, int len)
 
     while (start != nullptr)
     {
-      if (start->value <= pivot->value)
+      if (not less(pivot->value, start->value))
       {
         hold = start; // is this necessary
         start = hold->next;
@@ -559,8 +911,8 @@ typename LinkedSeq<T>::Node *LinkedSeq<T>::quick_sort(Node *start, int len)
       }
     }
 
-    smaller = quick_sort(smaller, smaller_len);
-    larger = quick_sort(larger, larger_len);
+    smaller = quick_sort(smaller, smaller_len, less);
+    larger = quick_sort(larger, larger_len, less);
 
     pivot->next = larger;
 
@@ -583,8 +935,10 @@ typename LinkedSeq<T>::Node *LinkedSeq<T>::quick_sort(Node *start, int len)
   }
 }
 
-template <typename T>
-typename LinkedSeq<T>::Node *LinkedSeq<T>::quick_sort_random(Node *start, int len)
+template <typename T, template <typename> class NodeAlloc>
+template <typename Less>
+typename LinkedSeq<T, NodeAlloc>::Node *
+LinkedSeq<T, NodeAlloc>::quick_sort_random(Node *start, int len, const Less &less)
 {
   if (len <= 1)
   {
@@ -593,17 +947,13 @@ typename LinkedSeq<T>::Node *LinkedSeq<T>::quick_sort_random(Node *start, int le
   else
   {
     int randIdx = rand() % (len - 1);
-    int pivotVal = 0, holdVal = 0;
     Node *pivot = start;
     for (int i = 0; i < randIdx; ++i)
     {
       pivot = pivot->next;
     }
-    pivotVal = pivot->value;
     // swap values of pivot and start
-    holdVal = start->value;
-    start->value = pivotVal;
-    pivot->value = holdVal;
+    std::swap(start->value, pivot->value);
 
     // take first node AND detach it from the list
     pivot = start;
@@ -620,7 +970,7 @@ typename LinkedSeq<T>::Node *LinkedSeq<T>::quick_sort_random(Node *start, int le
 
     while (start != nullptr)
     {
-      if (start->value <= pivot->value)
+      if (not less(pivot->value, start->value))
       {
         hold = start; // is this necessary
         start = hold->next;
@@ -658,8 +1008,8 @@ typename LinkedSeq<T>::Node *LinkedSeq<T>::quick_sort_random(Node *start, int le
       }
     }
 
-    smaller = quick_sort_random(smaller, smaller_len);
-    larger = quick_sort_random(larger, larger_len);
+    smaller = quick_sort_random(smaller, smaller_len, less);
+    larger = quick_sort_random(larger, larger_len, less);
 
     pivot->next = larger;
 
@@ -0,0 +1,293 @@
+//---------------------------------------------------------------------------
+// NAME: Joey Macauley
+// FILE: listsort.h
+// DATE: CPSC 223 - Spring 2022
+// DESC: Sorts for singly linked lists, shared by LinkedSeq (nodes
+//       linked by pointer) and ArenaSeq (nodes linked by 32-bit
+//       index). They only relink nodes, never move values, and reach
+//       the nodes through a link policy L:
+//         L::Link                        names a node
+//         Link nil() const               ends a list
+//         Link next(Link node) const     the node after node
+//         void set_next(Link node, Link next) const
+//         const auto &value(Link node) const
+//         void prefetch(Link node) const hints node will be read soon
+//       so one copy of each algorithm serves both layouts.
+//---------------------------------------------------------------------------
+
+#ifndef LISTSORT_H
+#define LISTSORT_H
+
+#include <utility>
+
+// Merges the sorted lists left and right and returns the head of the
+// result, taking from left on ties to stay stable
+template <typename Links, typename Less>
+typename Links::Link list_merge(const Links &links, typename Links::Link left,
+                                typename Links::Link right, const Less &less);
+
+// Sorts the list starting at head with iterative (bottom-up) merge
+// sort and returns its new head. Nodes are taken off the front one at
+// a time and merged into bins holding sorted runs of length 1, 2, 4,
+// ..., so no recursion or midpoint scans are needed. Stable.
+template <typename Links, typename Less>
+typename Links::Link list_bottom_up_merge_sort(const Links &links,
+                                               typename Links::Link head,
+                                               const Less &less);
+
+// Sorts the len nodes starting at start with quick sort, three-way
+// partitioning around the median of the first, quarter-way, and
+// middle nodes' values, and returns the new head; last is set to the
+// new last node. The equal nodes are placed once and left out of the
+// recursion, so all-equal and few-unique inputs take linear time.
+// Recurses only into the shorter side.
+template <typename Links, typename Less>
+typename Links::Link list_three_way_quick_sort(const Links &links,
+                                               typename Links::Link start, int len,
+                                               typename Links::Link &last,
+                                               const Less &less);
+
+template <typename Links, typename Less>
+typename Links::Link list_merge(const Links &links, typename Links::Link left,
+                                typename Links::Link right, const Less &less)
+{
+  typedef typename Links::Link Link;
+  const Link nil = links.nil();
+  if (left == nil)
+  {
+    return right;
+  }
+  if (right == nil)
+  {
+    return left;
+  }
+
+  Link front = nil;
+  if (not less(links.value(right), links.value(left)))
+  {
+    front = left;
+    left = links.next(left);
+  }
+  else
+  {
+    front = right;
+    right = links.next(right);
+  }
+  Link end = front;
+
+  // the node after the one just reached is prefetched, since scattered
+  // nodes miss the cache and its address is known a comparison early
+  while (left != nil and right != nil)
+  {
+    if (not less(links.value(right), links.value(left)))
+    {
+      links.set_next(end, left);
+      end = left;
+      left = links.next(left);
+      if (left != nil)
+      {
+        links.prefetch(links.next(left));
+      }
+    }
+    else
+    {
+      links.set_next(end, right);
+      end = right;
+      right = links.next(right);
+      if (right != nil)
+      {
+        links.prefetch(links.next(right));
+      }
+    }
+  }
+  links.set_next(end, left != nil ? left : right);
+  return front;
+}
+
+template <typename Links, typename Less>
+typename Links::Link list_bottom_up_merge_sort(const Links &links,
+                                               typename Links::Link head,
+                                               const Less &less)
+{
+  typedef typename Links::Link Link;
+  const Link nil = links.nil();
+  // bins[i] is either empty or a sorted run of 2^i nodes that came
+  // before everything in lower bins, so it is always the left side of
+  // a merge. 64 bins cover any int length.
+  Link bins[64];
+  int used_bins = 0;
+
+  while (head != nil)
+  {
+    Link carry = head;
+    head = links.next(head);
+    links.set_next(carry, nil);
+
+    int i = 0;
+    while (i < used_bins and bins[i] != nil)
+    {
+      carry = list_merge(links, bins[i], carry, less);
+      bins[i] = nil;
+      ++i;
+    }
+    bins[i] = carry;
+    if (i == used_bins)
+    {
+      ++used_bins;
+    }
+  }
+
+  for (int i = 0; i < used_bins; ++i)
+  {
+    head = list_merge(links, bins[i], head, less);
+  }
+  return head;
+}
+
+template <typename Links, typename Less>
+typename Links::Link list_three_way_quick_sort(const Links &links,
+                                               typename Links::Link start, int len,
+                                               typename Links::Link &last,
+                                               const Less &less)
+{
+  typedef typename Links::Link Link;
+  const Link nil = links.nil();
+  // sorted nodes that go before and after whatever is left in start
+  Link prefix = nil;
+  Link prefix_end = nil;
+  Link suffix = nil;
+  Link suffix_end = nil;
+
+  while (len > 1)
+  {
+    // median of the first node and the nodes a quarter and half way in,
+    // all picked up by one walk over the front half of the list
+    Link quarter = start;
+    for (int i = 0; i < len / 4; ++i)
+    {
+      quarter = links.next(quarter);
+    }
+    Link middle = quarter;
+    for (int i = len / 4; i < len / 2; ++i)
+    {
+      middle = links.next(middle);
+    }
+    const auto *a = &links.value(start);
+    const auto *b = &links.value(quarter);
+    const auto *c = &links.value(middle);
+    if (less(*b, *a))
+    {
+      std::swap(a, b);
+    }
+    if (less(*c, *b))
+    {
+      b = less(*c, *a) ? a : c;
+    }
+    const auto &pivot_val = *b; // nodes are relinked, never moved
+
+    Link lists[3] = {nil, nil, nil}; // less, equal, greater
+    Link ends[3] = {nil, nil, nil};
+    int lens[3] = {0, 0, 0};
+    while (start != nil)
+    {
+      Link hold = start;
+      start = links.next(hold);
+      links.set_next(hold, nil);
+
+      int which = 1;
+      if (less(links.value(hold), pivot_val))
+      {
+        which = 0;
+      }
+      else if (less(pivot_val, links.value(hold)))
+      {
+        which = 2;
+      }
+      if (lists[which] == nil)
+      {
+        lists[which] = hold;
+      }
+      else
+      {
+        links.set_next(ends[which], hold);
+      }
+      ends[which] = hold;
+      lens[which]++;
+    }
+
+    if (lens[0] < lens[2])
+    {
+      // sort the smaller list, then move it and the equal nodes onto
+      // the end of the prefix
+      Link sorted_end = nil;
+      Link sorted = list_three_way_quick_sort(links, lists[0], lens[0], sorted_end, less);
+      if (sorted != nil)
+      {
+        links.set_next(sorted_end, lists[1]);
+      }
+      else
+      {
+        sorted = lists[1];
+      }
+      if (prefix == nil)
+      {
+        prefix = sorted;
+      }
+      else
+      {
+        links.set_next(prefix_end, sorted);
+      }
+      prefix_end = ends[1];
+      start = lists[2];
+      len = lens[2];
+    }
+    else
+    {
+      // sort the greater list, then put the equal nodes and it in
+      // front of the suffix
+      Link sorted_end = nil;
+      Link sorted = list_three_way_quick_sort(links, lists[2], lens[2], sorted_end, less);
+      if (suffix_end == nil)
+      {
+        suffix_end = sorted != nil ? sorted_end : ends[1];
+      }
+      if (sorted != nil)
+      {
+        links.set_next(sorted_end, suffix);
+        suffix = sorted;
+      }
+      links.set_next(ends[1], suffix);
+      suffix = lists[1];
+      start = lists[0];
+      len = lens[0];
+    }
+  }
+
+  // stitch prefix + start (at most one node) + suffix together
+  Link front = suffix;
+  if (start != nil)
+  {
+    links.set_next(start, suffix);
+    front = start;
+  }
+  if (prefix != nil)
+  {
+    links.set_next(prefix_end, front);
+    front = prefix;
+  }
+  if (suffix_end != nil)
+  {
+    last = suffix_end;
+  }
+  else if (start != nil)
+  {
+    last = start;
+  }
+  else
+  {
+    last = prefix_end;
+  }
+  return front;
+}
+
+#endif
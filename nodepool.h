@@ -0,0 +1,221 @@
+//---------------------------------------------------------------------------
+// NAME: Joey Macauley
+// FILE: nodepool.h
+// DATE: CPSC 223 - Spring 2022
+// DESC: Node allocators for LinkedSeq, chosen with its NodeAlloc
+//       template parameter. Both hand out uninitialized storage for
+//       one Node at a time; LinkedSeq constructs and destroys the
+//       nodes in it.
+//
+//       HeapNodeAllocator gets every node from the global heap, so
+//       nodes land wherever malloc puts them and each is freed on
+//       its own.
+//
+//       PoolNodeAllocator carves nodes out of slabs that double in
+//       size (up to 64K nodes) as the list grows. Nodes are handed out
+//       in address order from the newest slab, so a list built by
+//       appending is laid out sequentially, and freed nodes go on an
+//       intrusive free list for reuse. release() frees every slab at
+//       once, which is how LinkedSeq::clear() and the destructor drop
+//       their nodes.
+//---------------------------------------------------------------------------
+
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+template <typename Node>
+class HeapNodeAllocator
+{
+public:
+  // Nodes must be freed one at a time with deallocate()
+  static const bool BULK_RELEASE = false;
+
+  // Returns storage for one node
+  Node *allocate();
+
+  // Frees storage from allocate()
+  void deallocate(Node *node);
+
+  // Nothing to release, every node was already deallocated
+  void release();
+};
+
+template <typename Node>
+class PoolNodeAllocator
+{
+public:
+  // release() frees every node, so nodes need not be deallocated
+  // one at a time first
+  static const bool BULK_RELEASE = true;
+
+  // Default constructor
+  PoolNodeAllocator();
+
+  // Move constructor and assignment, the slabs (and the nodes in
+  // them) change owner
+  PoolNodeAllocator(PoolNodeAllocator &&rhs);
+  PoolNodeAllocator &operator=(PoolNodeAllocator &&rhs);
+
+  // Pools own their nodes, so they are never copied
+  PoolNodeAllocator(const PoolNodeAllocator &rhs) = delete;
+  PoolNodeAllocator &operator=(const PoolNodeAllocator &rhs) = delete;
+
+  // Destructor, frees every slab
+  ~PoolNodeAllocator();
+
+  // Returns storage for one node, reusing a freed node if there is
+  // one
+  Node *allocate();
+
+  // Puts storage from allocate() on the free list
+  void deallocate(Node *node);
+
+  // Frees every slab, invalidating all nodes from this pool
+  void release();
+
+private:
+  // a node's storage, or a link in the free list while it is unused
+  union Slot
+  {
+    Slot *next_free;
+    alignas(Node) unsigned char storage[sizeof(Node)];
+  };
+
+  // first and largest slab sizes, in slots
+  static const int MIN_SLAB_SLOTS = 32;
+  static const int MAX_SLAB_SLOTS = 1 << 16;
+
+  // slot 0 of each slab links to the previous slab
+  Slot *slabs = nullptr;
+
+  // next never-used slot in the newest slab, and its end
+  Slot *bump = nullptr;
+  Slot *bump_end = nullptr;
+
+  // freed slots
+  Slot *free_list = nullptr;
+
+  // size of the next slab
+  int next_slab_slots = MIN_SLAB_SLOTS;
+
+  void add_slab();
+};
+
+template <typename Node>
+Node *HeapNodeAllocator<Node>::allocate()
+{
+  return static_cast<Node *>(::operator new(sizeof(Node)));
+}
+
+template <typename Node>
+void HeapNodeAllocator<Node>::deallocate(Node *node)
+{
+  ::operator delete(node);
+}
+
+template <typename Node>
+void HeapNodeAllocator<Node>::release()
+{
+}
+
+template <typename Node>
+PoolNodeAllocator<Node>::PoolNodeAllocator()
+{
+}
+
+template <typename Node>
+PoolNodeAllocator<Node>::PoolNodeAllocator(PoolNodeAllocator &&rhs)
+{
+  *this = std::move(rhs);
+}
+
+template <typename Node>
+PoolNodeAllocator<Node> &PoolNodeAllocator<Node>::operator=(PoolNodeAllocator &&rhs)
+{
+  if (this != &rhs)
+  {
+    release();
+    slabs = rhs.slabs;
+    bump = rhs.bump;
+    bump_end = rhs.bump_end;
+    free_list = rhs.free_list;
+    next_slab_slots = rhs.next_slab_slots;
+
+    rhs.slabs = nullptr;
+    rhs.bump = nullptr;
+    rhs.bump_end = nullptr;
+    rhs.free_list = nullptr;
+    rhs.next_slab_slots = MIN_SLAB_SLOTS;
+  }
+  return *this;
+}
+
+template <typename Node>
+PoolNodeAllocator<Node>::~PoolNodeAllocator()
+{
+  release();
+}
+
+template <typename Node>
+Node *PoolNodeAllocator<Node>::allocate()
+{
+  Slot *slot = free_list;
+  if (slot != nullptr)
+  {
+    free_list = slot->next_free;
+  }
+  else
+  {
+    if (bump == bump_end)
+    {
+      add_slab();
+    }
+    slot = bump++;
+  }
+  return reinterpret_cast<Node *>(slot->storage);
+}
+
+template <typename Node>
+void PoolNodeAllocator<Node>::deallocate(Node *node)
+{
+  Slot *slot = reinterpret_cast<Slot *>(node);
+  slot->next_free = free_list;
+  free_list = slot;
+}
+
+template <typename Node>
+void PoolNodeAllocator<Node>::release()
+{
+  while (slabs != nullptr)
+  {
+    Slot *prev = slabs[0].next_free;
+    ::operator delete(slabs, std::align_val_t(alignof(Slot)));
+    slabs = prev;
+  }
+  bump = nullptr;
+  bump_end = nullptr;
+  free_list = nullptr;
+  next_slab_slots = MIN_SLAB_SLOTS;
+}
+
+template <typename Node>
+void PoolNodeAllocator<Node>::add_slab()
+{
+  int slots = next_slab_slots;
+  Slot *slab = static_cast<Slot *>(
+      ::operator new(sizeof(Slot) * slots, std::align_val_t(alignof(Slot))));
+  slab[0].next_free = slabs;
+  slabs = slab;
+  bump = slab + 1;
+  bump_end = slab + slots;
+  if (next_slab_slots < MAX_SLAB_SLOTS)
+  {
+    next_slab_slots = next_slab_slots * 2;
+  }
+}
+
+#endif
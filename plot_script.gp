@@ -64,7 +64,31 @@ plot  infile u 1:2 t "ArraySeq Merge Sort, Reversed" w linespoints lw 3 lc rgb R
       infile u 1:9 t "LinkedSeq Merge Sort, Shuffled" w linespoints lw 2 lc rgb MAGENTA pointtype 6, \
       infile u 1:11 t "LinkedSeq Quick Sort, Shuffled" w linespoints lw 2 lc rgb LIME pointtype 6, \
       infile u 1:12 t "LinkedSeq Quick Random, Reversed" w linespoints lw 2 lc rgb PINK pointtype 6, \
-      infile u 1:13 t "LinkedSeq Quick Random, Shuffled" w linespoints lw 2 lc rgb TEAL pointtype 6;
+      infile u 1:13 t "LinkedSeq Quick Random, Shuffled" w linespoints lw 2 lc rgb TEAL pointtype 6, \
+      infile u 1:14 t "ArraySeq Intro Sort, Reversed" w linespoints lw 2 lc rgb LAVENDER pointtype 6, \
+      infile u 1:15 t "ArraySeq Intro Sort, Shuffled" w linespoints lw 2 lc rgb BROWN pointtype 6, \
+      infile u 1:16 t "ArraySeq Block Quick Sort, Reversed" w linespoints lw 2 lc rgb MAROON pointtype 6, \
+      infile u 1:17 t "ArraySeq Block Quick Sort, Shuffled" w linespoints lw 2 lc rgb NAVY pointtype 6, \
+      infile u 1:18 t "ArraySeq Buffered Merge Sort, Reversed" w linespoints lw 2 lc rgb OLIVE pointtype 6, \
+      infile u 1:19 t "ArraySeq Buffered Merge Sort, Shuffled" w linespoints lw 2 lc rgb GREY pointtype 6, \
+      infile u 1:20 t "ArraySeq Bottom-Up Merge Sort, Reversed" w linespoints lw 2 lc rgb MINT pointtype 6, \
+      infile u 1:21 t "ArraySeq Bottom-Up Merge Sort, Shuffled" w linespoints lw 2 lc rgb APRICOT pointtype 6, \
+      infile u 1:22 t "LinkedSeq Bottom-Up Merge Sort, Reversed" w linespoints lw 2 lc rgb YELLOW pointtype 6, \
+      infile u 1:23 t "LinkedSeq Bottom-Up Merge Sort, Shuffled" w linespoints lw 2 lc rgb BEIGE pointtype 6, \
+      infile u 1:24 t "ArraySeq Tim Sort, Reversed" w linespoints lw 2 lc rgb RED pointtype 4, \
+      infile u 1:25 t "ArraySeq Tim Sort, Shuffled" w linespoints lw 2 lc rgb GREEN pointtype 4, \
+      infile u 1:26 t "LinkedSeq Natural Merge Sort, Reversed" w linespoints lw 2 lc rgb BLUE pointtype 4, \
+      infile u 1:27 t "LinkedSeq Natural Merge Sort, Shuffled" w linespoints lw 2 lc rgb ORANGE pointtype 4, \
+      infile u 1:28 t "ArraySeq Radix Sort, Reversed" w linespoints lw 2 lc rgb PURPLE pointtype 4, \
+      infile u 1:29 t "ArraySeq Radix Sort, Shuffled" w linespoints lw 2 lc rgb CYAN pointtype 4, \
+      infile u 1:30 t "ArraySeq Three-Way Quick Sort, Reversed" w linespoints lw 2 lc rgb MAGENTA pointtype 4, \
+      infile u 1:31 t "ArraySeq Three-Way Quick Sort, Shuffled" w linespoints lw 2 lc rgb LIME pointtype 4, \
+      infile u 1:32 t "LinkedSeq Three-Way Quick Sort, Reversed" w linespoints lw 2 lc rgb PINK pointtype 4, \
+      infile u 1:33 t "LinkedSeq Three-Way Quick Sort, Shuffled" w linespoints lw 2 lc rgb TEAL pointtype 4, \
+      infile u 1:35 t "ArraySeq Three-Way Quick Sort, Few Unique" w linespoints lw 2 lc rgb LAVENDER pointtype 4, \
+      infile u 1:37 t "LinkedSeq Three-Way Quick Sort, Few Unique" w linespoints lw 2 lc rgb BROWN pointtype 4, \
+      infile u 1:38 t "ArraySeq Dual-Pivot Quick Sort, Reversed" w linespoints lw 2 lc rgb MAROON pointtype 4, \
+      infile u 1:39 t "ArraySeq Dual-Pivot Quick Sort, Shuffled" w linespoints lw 2 lc rgb NAVY pointtype 4;
       
 # Plot the "slow" data
 set output outfile2
@@ -72,6 +96,8 @@ set title "LinkedSeq vs ArraySeq Sort Performance (Slow)";
 plot   infile u 1:4 t "ArraySeq Quick Sort, Reversed" w linespoints lw 3 lc rgb RED pointtype 6, \
        infile u 1:6 t "ArraySeq Quick Random, Reversed" w linespoints lw 2 lc rgb GREEN pointtype 6, \
        infile u 1:10 t "LinkedSeq Quick Sort, Reversed" w linespoints lw 2 lc rgb BLUE pointtype 6, \
-       infile u 1:12 t "LinkedSeq Quick Random, Reversed" w linespoints lw 2 lc rgb ORANGE pointtype 6;
+       infile u 1:12 t "LinkedSeq Quick Random, Reversed" w linespoints lw 2 lc rgb ORANGE pointtype 6, \
+       infile u 1:34 t "ArraySeq Quick Random, Few Unique" w linespoints lw 2 lc rgb PURPLE pointtype 6, \
+       infile u 1:36 t "LinkedSeq Quick Random, Few Unique" w linespoints lw 2 lc rgb CYAN pointtype 6;
 
 
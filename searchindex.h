@@ -0,0 +1,168 @@
+//---------------------------------------------------------------------------
+// NAME: Joey Macauley
+// FILE: searchindex.h
+// DATE: CPSC 223 - Spring 2022
+// DESC: A frozen, read-only search index over a sorted ArraySeq. The
+//       elements are copied into Eytzinger (breadth-first) order:
+//       the root is at 1 and the children of node k are at 2k and
+//       2k+1. A search walks down from the root with one comparison
+//       per level and no branches, and prefetches the cache line
+//       holding the node's descendants a few levels below. The top
+//       of the tree stays in cache across queries, so on large
+//       sequences this is several times faster than binary search,
+//       which misses the cache on almost every probe.
+//---------------------------------------------------------------------------
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include "arrayseq.h"
+
+template <typename T>
+class SearchIndex
+{
+public:
+  // Builds the index from a copy of the elements in seq. Throws
+  // logic_error unless seq.is_sorted(). Later changes to seq are not
+  // seen by the index.
+  explicit SearchIndex(const ArraySeq<T> &seq);
+
+  // Move constructor
+  SearchIndex(SearchIndex &&rhs);
+
+  // The index is frozen, so it is never copied
+  SearchIndex(const SearchIndex &rhs) = delete;
+  SearchIndex &operator=(const SearchIndex &rhs) = delete;
+
+  // Destructor
+  ~SearchIndex();
+
+  // Returns the number of elements in the index
+  int size() const;
+
+  // Returns true if the element is in the index, and false otherwise
+  bool contains(const T &elem) const;
+
+  // Returns the index (in the sorted sequence the index was built
+  // from) of the first element not less than elem, or size() if
+  // there is none
+  int lower_bound(const T &elem) const;
+
+private:
+  // cache line size in bytes, the tree storage is aligned to it
+  static const int CACHE_LINE = 64;
+
+  // children this many levels down from node k start at k times
+  // PREFETCH_STRIDE and fill one cache line
+  static const long long PREFETCH_STRIDE =
+      sizeof(T) < CACHE_LINE ? CACHE_LINE / sizeof(T) : 1;
+
+  // elements in Eytzinger order, slot 0 is unused
+  T *tree = nullptr;
+
+  // rank[k] is the sorted position of tree[k]
+  int *rank = nullptr;
+
+  // number of elements
+  int count = 0;
+
+  // fills the subtree rooted at k from seq in order, next is the next
+  // sorted position to place
+  void build(const ArraySeq<T> &seq, int &next, long long k);
+
+  // returns the tree index of the first element not less than elem,
+  // or 0 if there is none
+  long long descend(const T &elem) const;
+};
+
+template <typename T>
+SearchIndex<T>::SearchIndex(const ArraySeq<T> &seq)
+{
+  if (not seq.is_sorted())
+  {
+    throw std::logic_error("Sequence not sorted");
+  }
+  if (seq.empty())
+  {
+    return;
+  }
+  count = seq.size();
+  tree = static_cast<T *>(::operator new(sizeof(T) * (count + 1LL),
+                                         std::align_val_t(CACHE_LINE)));
+  rank = new int[count + 1LL];
+  int next = 0;
+  build(seq, next, 1);
+}
+
+template <typename T>
+SearchIndex<T>::SearchIndex(SearchIndex &&rhs)
+    : tree(rhs.tree), rank(rhs.rank), count(rhs.count)
+{
+  rhs.tree = nullptr;
+  rhs.rank = nullptr;
+  rhs.count = 0;
+}
+
+template <typename T>
+SearchIndex<T>::~SearchIndex()
+{
+  for (long long k = 1; k <= count; ++k)
+  {
+    tree[k].~T();
+  }
+  ::operator delete(tree, std::align_val_t(CACHE_LINE));
+  delete[] rank;
+}
+
+template <typename T>
+int SearchIndex<T>::size() const
+{
+  return count;
+}
+
+template <typename T>
+bool SearchIndex<T>::contains(const T &elem) const
+{
+  long long k = descend(elem);
+  return k != 0 and not(elem < tree[k]);
+}
+
+template <typename T>
+int SearchIndex<T>::lower_bound(const T &elem) const
+{
+  long long k = descend(elem);
+  return k == 0 ? count : rank[k];
+}
+
+template <typename T>
+void SearchIndex<T>::build(const ArraySeq<T> &seq, int &next, long long k)
+{
+  // in-order walk, depth is only log2(n)
+  if (k <= count)
+  {
+    build(seq, next, 2 * k);
+    new (tree + k) T(seq[next]);
+    rank[k] = next++;
+    build(seq, next, 2 * k + 1);
+  }
+}
+
+template <typename T>
+long long SearchIndex<T>::descend(const T &elem) const
+{
+  long long k = 1;
+  while (k <= count)
+  {
+    __builtin_prefetch(tree + k * PREFETCH_STRIDE);
+    k = 2 * k + (tree[k] < elem);
+  }
+  // the path turned left at the answer and right at every node
+  // below it, so drop those right turns (trailing ones) and that left
+  // turn to get back to the answer
+  return k >> __builtin_ffsll(~k);
+}
+
+#endif
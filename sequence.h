@@ -54,6 +54,10 @@ public:
   // Sorts the elements in the sequence using less than equal (<=)
   // operator.
   virtual void sort() = 0; 
+
+  // Hint that the sequence is about to grow to n elements, so storage
+  // can be set aside up front. Does nothing by default.
+  virtual void reserve(int /*n*/) {}
   
 };
 
@@ -0,0 +1,210 @@
+//---------------------------------------------------------------------------
+// NAME: Joey Macauley
+// FILE: simdscan.h
+// DATE: CPSC 223 - Spring 2022
+// DESC: Vectorized equality scans over int, float and double arrays
+//       for ArraySeq::contains(). Each kernel compares two vectors
+//       per step (16 ints or floats, or 8 doubles with AVX2; half that
+//       with SSE4.2), checks both with one mask test, and stops at the
+//       first match. The widest instruction set the CPU supports is
+//       picked once at run time, so the binary still runs on machines
+//       without AVX2. Other platforms use the plain loop. Floating
+//       point keys compare like ==, so NaN matches nothing and -0.0
+//       matches 0.0.
+//---------------------------------------------------------------------------
+
+#ifndef SIMDSCAN_H
+#define SIMDSCAN_H
+
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMDSCAN_X86 1
+#endif
+
+// Instruction sets simd_find() can use, in increasing width
+enum SimdLevel
+{
+  SIMD_NONE,
+  SIMD_SSE42,
+  SIMD_AVX2
+};
+
+// True for the element types simd_find() has vector kernels for
+template <typename T>
+struct has_simd_find
+    : std::integral_constant<bool, std::is_same<T, int>::value or
+                                       std::is_same<T, float>::value or
+                                       std::is_same<T, double>::value>
+{
+};
+
+// Returns the widest instruction set the CPU supports
+inline SimdLevel simd_level()
+{
+#ifdef SIMDSCAN_X86
+  static const SimdLevel level = __builtin_cpu_supports("avx2")     ? SIMD_AVX2
+                                 : __builtin_cpu_supports("sse4.2") ? SIMD_SSE42
+                                                                    : SIMD_NONE;
+  return level;
+#else
+  return SIMD_NONE;
+#endif
+}
+
+// Plain loop, used for the tail of every vector scan
+template <typename T>
+int scalar_find(const T *data, int start, int n, T value)
+{
+  for (int i = start; i < n; ++i)
+  {
+    if (data[i] == value)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+#ifdef SIMDSCAN_X86
+
+__attribute__((target("avx2"))) inline int avx2_find(const int *data, int n,
+                                                     int value)
+{
+  __m256i key = _mm256_set1_epi32(value);
+  int i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    __m256 lo = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), key));
+    __m256 hi = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 8)), key));
+    int mask = _mm256_movemask_ps(lo) | _mm256_movemask_ps(hi) << 8;
+    if (mask != 0)
+    {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return scalar_find(data, i, n, value);
+}
+
+__attribute__((target("avx2"))) inline int avx2_find(const float *data, int n,
+                                                     float value)
+{
+  __m256 key = _mm256_set1_ps(value);
+  int i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    __m256 lo = _mm256_cmp_ps(_mm256_loadu_ps(data + i), key, _CMP_EQ_OQ);
+    __m256 hi = _mm256_cmp_ps(_mm256_loadu_ps(data + i + 8), key, _CMP_EQ_OQ);
+    int mask = _mm256_movemask_ps(lo) | _mm256_movemask_ps(hi) << 8;
+    if (mask != 0)
+    {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return scalar_find(data, i, n, value);
+}
+
+__attribute__((target("avx2"))) inline int avx2_find(const double *data, int n,
+                                                     double value)
+{
+  __m256d key = _mm256_set1_pd(value);
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256d lo = _mm256_cmp_pd(_mm256_loadu_pd(data + i), key, _CMP_EQ_OQ);
+    __m256d hi = _mm256_cmp_pd(_mm256_loadu_pd(data + i + 4), key, _CMP_EQ_OQ);
+    int mask = _mm256_movemask_pd(lo) | _mm256_movemask_pd(hi) << 4;
+    if (mask != 0)
+    {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return scalar_find(data, i, n, value);
+}
+
+__attribute__((target("sse4.2"))) inline int sse42_find(const int *data, int n,
+                                                        int value)
+{
+  __m128i key = _mm_set1_epi32(value);
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m128 lo = _mm_castsi128_ps(_mm_cmpeq_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), key));
+    __m128 hi = _mm_castsi128_ps(_mm_cmpeq_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 4)), key));
+    int mask = _mm_movemask_ps(lo) | _mm_movemask_ps(hi) << 4;
+    if (mask != 0)
+    {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return scalar_find(data, i, n, value);
+}
+
+__attribute__((target("sse4.2"))) inline int sse42_find(const float *data, int n,
+                                                        float value)
+{
+  __m128 key = _mm_set1_ps(value);
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m128 lo = _mm_cmpeq_ps(_mm_loadu_ps(data + i), key);
+    __m128 hi = _mm_cmpeq_ps(_mm_loadu_ps(data + i + 4), key);
+    int mask = _mm_movemask_ps(lo) | _mm_movemask_ps(hi) << 4;
+    if (mask != 0)
+    {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return scalar_find(data, i, n, value);
+}
+
+__attribute__((target("sse4.2"))) inline int sse42_find(const double *data, int n,
+                                                        double value)
+{
+  __m128d key = _mm_set1_pd(value);
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128d lo = _mm_cmpeq_pd(_mm_loadu_pd(data + i), key);
+    __m128d hi = _mm_cmpeq_pd(_mm_loadu_pd(data + i + 2), key);
+    int mask = _mm_movemask_pd(lo) | _mm_movemask_pd(hi) << 2;
+    if (mask != 0)
+    {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return scalar_find(data, i, n, value);
+}
+
+#endif
+
+// Returns the index of the first of data[0..n-1] equal to value, or
+// -1 if there is none, using at most the given instruction set (it is
+// lowered to what the CPU supports). T must be int, float or double.
+template <typename T>
+int simd_find(const T *data, int n, T value, SimdLevel level = SIMD_AVX2)
+{
+  static_assert(has_simd_find<T>::value, "simd_find needs int, float or double");
+#ifdef SIMDSCAN_X86
+  if (level > simd_level())
+  {
+    level = simd_level();
+  }
+  if (level == SIMD_AVX2)
+  {
+    return avx2_find(data, n, value);
+  }
+  if (level == SIMD_SSE42)
+  {
+    return sse42_find(data, n, value);
+  }
+#endif
+  return scalar_find(data, 0, n, value);
+}
+
+#endif
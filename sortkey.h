@@ -0,0 +1,86 @@
+//---------------------------------------------------------------------------
+// NAME: Joey Macauley
+// FILE: sortkey.h
+// DATE: CPSC 223 - Spring 2022
+// DESC: Comparator and key projection helpers for the ArraySeq and
+//       LinkedSeq sorts. Every sort takes a comparator comp (default
+//       std::less<>) and a projection proj (default Identity) as
+//       template parameters and orders elements a and b by
+//       comp(proj(a), proj(b)), so records can be sorted on one of
+//       their fields without a wrapper type. Both are stored by value
+//       and called directly, so they inline like operator<.
+//---------------------------------------------------------------------------
+
+#ifndef SORTKEY_H
+#define SORTKEY_H
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Projection that returns its argument unchanged
+struct Identity
+{
+  template <typename U>
+  constexpr U &&operator()(U &&value) const noexcept
+  {
+    return std::forward<U>(value);
+  }
+};
+
+// Element ordering built from a key comparator and a projection from
+// elements to keys. The projection may be any callable, including a
+// pointer to a data member such as &Record::timestamp. Both must be
+// callable on const arguments, and the parallel sorts call them from
+// several threads at once.
+template <typename Compare, typename Project>
+class KeyLess
+{
+public:
+  KeyLess(Compare comp, Project proj);
+
+  // Returns true if lhs goes before rhs
+  template <typename U>
+  bool operator()(const U &lhs, const U &rhs) const;
+
+private:
+  Compare comp;
+  Project proj;
+};
+
+// Type of the key proj returns for an element of type T
+template <typename T, typename Project>
+using sort_key_t = typename std::decay<
+    typename std::invoke_result<const Project &, const T &>::type>::type;
+
+// True if Compare orders keys of type Key by their own operator<, so
+// a sort may use a key-based algorithm such as radix sort instead
+template <typename Compare, typename Key>
+struct is_natural_order : std::false_type
+{
+};
+
+template <typename Key>
+struct is_natural_order<std::less<>, Key> : std::true_type
+{
+};
+
+template <typename Key>
+struct is_natural_order<std::less<Key>, Key> : std::true_type
+{
+};
+
+template <typename Compare, typename Project>
+KeyLess<Compare, Project>::KeyLess(Compare comp, Project proj)
+    : comp(std::move(comp)), proj(std::move(proj))
+{
+}
+
+template <typename Compare, typename Project>
+template <typename U>
+bool KeyLess<Compare, Project>::operator()(const U &lhs, const U &rhs) const
+{
+  return comp(std::invoke(proj, lhs), std::invoke(proj, rhs));
+}
+
+#endif
@@ -0,0 +1,625 @@
+//---------------------------------------------------------------------------
+// NAME: Joey Macauley
+// FILE: unrolledseq.h
+// DATE: CPSC 223 - Spring 2022
+// DESC: Unrolled linked list implementation of Sequence. Each node
+//       (block) holds up to a cache line's worth of elements plus a
+//       fill count, so a list of ints spends most of its memory on
+//       the ints instead of on next pointers, and a traversal makes
+//       one dependent load per block instead of one per element.
+//       Inserting into a full block splits it in two (appending past
+//       a full tail just starts a new block), and erasing merges a
+//       block that drops below half full with its neighbor when both
+//       fit in one. Blocks come from the same node allocators as
+//       LinkedSeq (see nodepool.h).
+//---------------------------------------------------------------------------
+
+#ifndef UNROLLEDSEQ_H
+#define UNROLLEDSEQ_H
+
+#include <stdexcept>
+#include <ostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "nodepool.h"
+#include "sequence.h"
+#include "sortkey.h"
+
+template <typename T, template <typename> class NodeAlloc = PoolNodeAllocator>
+class UnrolledSeq : public Sequence<T>
+{
+public:
+  // Default constructor
+  UnrolledSeq();
+
+  // Copy constructor
+  UnrolledSeq(const UnrolledSeq &rhs);
+
+  // Move constructor
+  UnrolledSeq(UnrolledSeq &&rhs);
+
+  // Copy assignment operator
+  UnrolledSeq &operator=(const UnrolledSeq &rhs);
+
+  // Move assignment operator
+  UnrolledSeq &operator=(UnrolledSeq &&rhs);
+
+  // Destructor
+  ~UnrolledSeq();
+
+  // Returns the number of elements in the sequence
+  int size() const override;
+
+  // Tests if the sequence is empty
+  bool empty() const override;
+
+  // Removes all of the elements from the sequence
+  void clear() override;
+
+  // Returns a reference to the element at the index in the
+  // sequence. Throws out_of_range if index is invalid.
+  T &operator[](int index) override;
+
+  // Returns a constant address to the element at the index in the
+  // sequence. Throws out_of_range if index is invalid.
+  const T &operator[](int index) const override;
+
+  // Extends the sequence by inserting the element at the given
+  // index. Throws out_of_range if the index is invalid.
+  void insert(const T &elem, int index) override;
+
+  // Same as above, but moves the element into the sequence instead of
+  // copying it
+  void insert(T &&elem, int index);
+
+  // Shrinks the sequence by removing the element at the index in the
+  // sequence. Throws out_of_range if index is invalid.
+  void erase(int index) override;
+
+  // Returns true if the element is in the sequence, and false
+  // otherwise.
+  bool contains(const T &elem) const override;
+
+  // Sorts the elements in the sequence in place using less than equal
+  // (<=) operator. Uses merge sort.
+  void sort() override;
+
+  // Sorts the sequence in place using block-wise merge sort. Each
+  // block is insertion sorted as a run of its own, then runs of
+  // blocks are merged bottom-up (as in
+  // LinkedSeq::bottom_up_merge_sort()) into fresh full blocks, reusing
+  // the blocks each merge empties. Takes the same optional comparator
+  // and projection as the LinkedSeq sorts (see sortkey.h). Stable.
+  template <typename Compare = std::less<>, typename Project = Identity>
+  void merge_sort(Compare comp = Compare(), Project proj = Project());
+
+  // Returns the number of blocks in the list
+  int block_count() const;
+
+  // Returns the bytes used by the list's blocks
+  long long memory_bytes() const;
+
+private:
+  // cache line size in bytes, each block is about this big for small
+  // element types
+  static const int CACHE_LINE = 64;
+
+  // elements per block: what fits in a cache line after the next
+  // pointer and fill count, but at least 4 for large element types
+  static const int BLOCK_CAPACITY =
+      (CACHE_LINE - 2 * (int)sizeof(void *)) / (int)sizeof(T) > 4
+          ? (CACHE_LINE - 2 * (int)sizeof(void *)) / (int)sizeof(T)
+          : 4;
+
+  // list node holding up to BLOCK_CAPACITY elements, of which the
+  // first fill are constructed
+  struct Block
+  {
+    Block *next = nullptr;
+    int fill = 0;
+    alignas(T) unsigned char storage[BLOCK_CAPACITY * sizeof(T)];
+
+    T *items();
+  };
+
+  // head pointer
+  Block *head = nullptr;
+
+  // tail pointer
+  Block *tail = nullptr;
+
+  // size of list
+  int count = 0;
+
+  // number of blocks
+  int blocks_used = 0;
+
+  // storage for the blocks
+  NodeAlloc<Block> blocks;
+
+  // returns a new empty block, and frees an empty one
+  Block *make_block();
+  void free_block(Block *block);
+
+  // finds the block holding the element at index, and that element's
+  // offset in the block; prev is the block before it (or null)
+  Block *locate(int index, int &offset, Block *&prev) const;
+
+  // sort function helpers
+  template <typename Less>
+  static void insertion_sort(Block *block, const Less &less);
+  template <typename Less>
+  Block *merge(Block *left, Block *right, const Less &less);
+
+  // number of bins used by merge_sort(), bin i holds a run of 2^i
+  // blocks' elements
+  static const int MERGE_BINS = 64;
+};
+
+template <typename T, template <typename> class NodeAlloc>
+std::ostream &operator<<(std::ostream &stream, const UnrolledSeq<T, NodeAlloc> &seq)
+{
+  int n = seq.size();
+  for (int i = 0; i < n - 1; ++i)
+    stream << seq[i] << ", ";
+  if (n > 0)
+    stream << seq[n - 1];
+  return stream;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+T *UnrolledSeq<T, NodeAlloc>::Block::items()
+{
+  return std::launder(reinterpret_cast<T *>(storage));
+}
+
+template <typename T, template <typename> class NodeAlloc>
+UnrolledSeq<T, NodeAlloc>::UnrolledSeq()
+{
+}
+
+template <typename T, template <typename> class NodeAlloc>
+UnrolledSeq<T, NodeAlloc>::UnrolledSeq(const UnrolledSeq &rhs)
+{
+  *this = rhs;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+UnrolledSeq<T, NodeAlloc>::UnrolledSeq(UnrolledSeq &&rhs)
+{
+  *this = std::move(rhs);
+}
+
+template <typename T, template <typename> class NodeAlloc>
+UnrolledSeq<T, NodeAlloc> &UnrolledSeq<T, NodeAlloc>::operator=(const UnrolledSeq &rhs)
+{
+  if (this != &rhs)
+  {
+    clear();
+    for (Block *block = rhs.head; block != nullptr; block = block->next)
+    {
+      T *items = block->items();
+      for (int i = 0; i < block->fill; ++i)
+      {
+        insert(items[i], count);
+      }
+    }
+  }
+  return *this;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+UnrolledSeq<T, NodeAlloc> &UnrolledSeq<T, NodeAlloc>::operator=(UnrolledSeq &&rhs)
+{
+  if (this != &rhs)
+  {
+    clear();
+    head = rhs.head;
+    tail = rhs.tail;
+    count = rhs.count;
+    blocks_used = rhs.blocks_used;
+    blocks = std::move(rhs.blocks);
+
+    rhs.head = nullptr;
+    rhs.tail = nullptr;
+    rhs.count = 0;
+    rhs.blocks_used = 0;
+  }
+  return *this;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+UnrolledSeq<T, NodeAlloc>::~UnrolledSeq()
+{
+  clear();
+}
+
+template <typename T, template <typename> class NodeAlloc>
+int UnrolledSeq<T, NodeAlloc>::size() const
+{
+  return count;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+bool UnrolledSeq<T, NodeAlloc>::empty() const
+{
+  return count == 0;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void UnrolledSeq<T, NodeAlloc>::clear()
+{
+  Block *block = head;
+  while (block != nullptr)
+  {
+    Block *next = block->next;
+    std::destroy(block->items(), block->items() + block->fill);
+    block->fill = 0;
+    if constexpr (not NodeAlloc<Block>::BULK_RELEASE)
+    {
+      free_block(block);
+    }
+    block = next;
+  }
+  blocks.release();
+  head = nullptr;
+  tail = nullptr;
+  count = 0;
+  blocks_used = 0;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+T &UnrolledSeq<T, NodeAlloc>::operator[](int index)
+{
+  if (index < 0 or index >= size())
+  {
+    throw std::out_of_range("Invalid index");
+  }
+  int offset = 0;
+  Block *prev = nullptr;
+  return locate(index, offset, prev)->items()[offset];
+}
+
+template <typename T, template <typename> class NodeAlloc>
+const T &UnrolledSeq<T, NodeAlloc>::operator[](int index) const
+{
+  if (index < 0 or index >= size())
+  {
+    throw std::out_of_range("Invalid index");
+  }
+  int offset = 0;
+  Block *prev = nullptr;
+  return locate(index, offset, prev)->items()[offset];
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void UnrolledSeq<T, NodeAlloc>::insert(const T &elem, int index)
+{
+  insert(T(elem), index);
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void UnrolledSeq<T, NodeAlloc>::insert(T &&elem, int index)
+{
+  if (index < 0 or index > size())
+  {
+    throw std::out_of_range("Invalid index");
+  }
+  if (tail == nullptr)
+  {
+    head = make_block();
+    tail = head;
+  }
+
+  Block *block = tail;
+  int offset = tail->fill;
+  if (index < count)
+  {
+    Block *prev = nullptr;
+    block = locate(index, offset, prev);
+  }
+
+  if (block->fill == BLOCK_CAPACITY)
+  {
+    Block *spill = make_block();
+    spill->next = block->next;
+    block->next = spill;
+    if (tail == block)
+    {
+      tail = spill;
+    }
+    if (offset == BLOCK_CAPACITY)
+    {
+      // appending past a full block starts the new one
+      block = spill;
+      offset = 0;
+    }
+    else
+    {
+      // split, moving the upper half to the new block
+      int half = BLOCK_CAPACITY / 2;
+      T *items = block->items();
+      std::uninitialized_move(items + half, items + BLOCK_CAPACITY, spill->items());
+      std::destroy(items + half, items + BLOCK_CAPACITY);
+      spill->fill = BLOCK_CAPACITY - half;
+      block->fill = half;
+      if (offset > half)
+      {
+        block = spill;
+        offset = offset - half;
+      }
+    }
+  }
+
+  T *items = block->items();
+  if (offset == block->fill)
+  {
+    new (items + offset) T(std::move(elem));
+  }
+  else
+  {
+    new (items + block->fill) T(std::move(items[block->fill - 1]));
+    std::move_backward(items + offset, items + block->fill - 1, items + block->fill);
+    items[offset] = std::move(elem);
+  }
+  block->fill++;
+  count++;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void UnrolledSeq<T, NodeAlloc>::erase(int index)
+{
+  if (index < 0 or index >= size())
+  {
+    throw std::out_of_range("Invalid index");
+  }
+  int offset = 0;
+  Block *prev = nullptr;
+  Block *block = locate(index, offset, prev);
+  T *items = block->items();
+  std::move(items + offset + 1, items + block->fill, items + offset);
+  items[block->fill - 1].~T();
+  block->fill--;
+  count--;
+
+  if (block->fill == 0)
+  {
+    // unlink the empty block
+    Block *next = block->next;
+    if (prev == nullptr)
+    {
+      head = next;
+    }
+    else
+    {
+      prev->next = next;
+    }
+    if (tail == block)
+    {
+      tail = prev;
+    }
+    free_block(block);
+  }
+  else if (block->fill < BLOCK_CAPACITY / 2 and block->next != nullptr and
+           block->fill + block->next->fill <= BLOCK_CAPACITY)
+  {
+    // merge the next block into this one
+    Block *next = block->next;
+    T *next_items = next->items();
+    std::uninitialized_move(next_items, next_items + next->fill, items + block->fill);
+    std::destroy(next_items, next_items + next->fill);
+    block->fill += next->fill;
+    next->fill = 0;
+    block->next = next->next;
+    if (tail == next)
+    {
+      tail = block;
+    }
+    free_block(next);
+  }
+}
+
+template <typename T, template <typename> class NodeAlloc>
+bool UnrolledSeq<T, NodeAlloc>::contains(const T &elem) const
+{
+  for (Block *block = head; block != nullptr; block = block->next)
+  {
+    T *items = block->items();
+    for (int i = 0; i < block->fill; ++i)
+    {
+      if (items[i] == elem)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void UnrolledSeq<T, NodeAlloc>::sort()
+{
+  merge_sort();
+}
+
+template <typename T, template <typename> class NodeAlloc>
+int UnrolledSeq<T, NodeAlloc>::block_count() const
+{
+  return blocks_used;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+long long UnrolledSeq<T, NodeAlloc>::memory_bytes() const
+{
+  return (long long)blocks_used * sizeof(Block);
+}
+
+template <typename T, template <typename> class NodeAlloc>
+typename UnrolledSeq<T, NodeAlloc>::Block *UnrolledSeq<T, NodeAlloc>::make_block()
+{
+  ++blocks_used;
+  return new (blocks.allocate()) Block;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+void UnrolledSeq<T, NodeAlloc>::free_block(Block *block)
+{
+  --blocks_used;
+  block->~Block();
+  blocks.deallocate(block);
+}
+
+template <typename T, template <typename> class NodeAlloc>
+typename UnrolledSeq<T, NodeAlloc>::Block *
+UnrolledSeq<T, NodeAlloc>::locate(int index, int &offset, Block *&prev) const
+{
+  Block *block = head;
+  prev = nullptr;
+  while (index >= block->fill)
+  {
+    index -= block->fill;
+    prev = block;
+    block = block->next;
+  }
+  offset = index;
+  return block;
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Compare, typename Project>
+void UnrolledSeq<T, NodeAlloc>::merge_sort(Compare comp, Project proj)
+{
+  KeyLess<Compare, Project> less(comp, proj);
+  // bins[i] is either empty or a sorted run that came before
+  // everything in lower bins, so it is always the left side of a
+  // merge
+  Block *bins[MERGE_BINS] = {};
+  int used_bins = 0;
+
+  while (head != nullptr)
+  {
+    Block *carry = head;
+    head = head->next;
+    carry->next = nullptr;
+    insertion_sort(carry, less);
+
+    int i = 0;
+    while (i < used_bins and bins[i] != nullptr)
+    {
+      carry = merge(bins[i], carry, less);
+      bins[i] = nullptr;
+      ++i;
+    }
+    bins[i] = carry;
+    if (i == used_bins)
+    {
+      ++used_bins;
+    }
+  }
+
+  for (int i = 0; i < used_bins; ++i)
+  {
+    head = merge(bins[i], head, less);
+  }
+
+  tail = head;
+  while (tail != nullptr and tail->next != nullptr)
+  {
+    tail = tail->next;
+  }
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Less>
+void UnrolledSeq<T, NodeAlloc>::insertion_sort(Block *block, const Less &less)
+{
+  T *items = block->items();
+  for (int i = 1; i < block->fill; ++i)
+  {
+    T hold = std::move(items[i]);
+    int j = i;
+    while (j > 0 and less(hold, items[j - 1]))
+    {
+      items[j] = std::move(items[j - 1]);
+      --j;
+    }
+    items[j] = std::move(hold);
+  }
+}
+
+template <typename T, template <typename> class NodeAlloc>
+template <typename Less>
+typename UnrolledSeq<T, NodeAlloc>::Block *
+UnrolledSeq<T, NodeAlloc>::merge(Block *left, Block *right, const Less &less)
+{
+  if (left == nullptr)
+  {
+    return right;
+  }
+  if (right == nullptr)
+  {
+    return left;
+  }
+
+  // move elements one at a time into full output blocks; each input
+  // block is freed as soon as it is used up, so the next output block
+  // usually reuses it
+  Block *out_head = nullptr;
+  Block *out = nullptr;
+  int l = 0, r = 0;
+  while (left != nullptr and right != nullptr)
+  {
+    bool take_right = less(right->items()[r], left->items()[l]);
+    T *src = take_right ? right->items() + r : left->items() + l;
+    if (out == nullptr or out->fill == BLOCK_CAPACITY)
+    {
+      Block *fresh = make_block();
+      if (out == nullptr)
+      {
+        out_head = fresh;
+      }
+      else
+      {
+        out->next = fresh;
+      }
+      out = fresh;
+    }
+    new (out->items() + out->fill) T(std::move(*src));
+    src->~T();
+    out->fill++;
+
+    Block *&from = take_right ? right : left;
+    int &at = take_right ? r : l;
+    if (++at == from->fill)
+    {
+      Block *used = from;
+      from = from->next;
+      used->fill = 0;
+      free_block(used);
+      at = 0;
+    }
+  }
+
+  // shift what is left of the partly used block down and link the
+  // rest of that run on as it is. The slots before at were destroyed
+  // as they were merged, and each slot is destroyed again once it is
+  // moved from, so every move constructs into a dead slot.
+  Block *rest = left != nullptr ? left : right;
+  int at = left != nullptr ? l : r;
+  if (rest != nullptr and at > 0)
+  {
+    T *items = rest->items();
+    for (int i = 0; i < rest->fill - at; ++i)
+    {
+      new (items + i) T(std::move(items[at + i]));
+      items[at + i].~T();
+    }
+    rest->fill -= at;
+  }
+  out->next = rest;
+  return out_head;
+}
+
+#endif
@@ -17,12 +17,13 @@ void faro_shuffle(Sequence<int>& seq, int shuffles)
   bool out_shuffle = true;
   
   for (int s = 0; s < shuffles; ++s) {
-    for (int i = 0; i < n/2; ++i) {    
-      int j = n/2 + i;
-      int index = 2*i;
-      tmp_array[index] = out_shuffle ? seq[i] : seq[j];
-      tmp_array[index + 1] = out_shuffle ? seq[j] : seq[i];
-    }
+    // each half is read in its own pass in index order, so a linked
+    // list walks on from its last position instead of from the head
+    int first = out_shuffle ? 0 : 1;
+    for (int i = 0; i < n/2; ++i)
+      tmp_array[2*i + first] = seq[i];
+    for (int j = n/2; j < 2*(n/2); ++j)
+      tmp_array[2*(j - n/2) + 1 - first] = seq[j];
     for (int i = 0; i < n; ++i)
       seq[i] = tmp_array[i];
     out_shuffle = !out_shuffle;
@@ -38,16 +39,25 @@ void load_shuffled(Sequence<int>& s, int n, int shuffles)
 
 void load_in_order(Sequence<int>& s, int n)
 {
+  s.reserve(s.size() + n);
   for (int i = 0; i < n; ++i)
     s.insert(i+1, i);
 }
 
 void load_reverse_order(Sequence<int>& s, int n)
 {
+  s.reserve(s.size() + n);
   for (int i = 0; i < n; ++i)
     s.insert(n-i, i);
 }
 
+void load_few_unique(Sequence<int>& s, int n, int k)
+{
+  s.reserve(s.size() + n);
+  for (int i = 0; i < n; ++i)
+    s.insert((int)((i * 2654435761u) % k) + 1, i);
+}
+
 void reset_ordered(Sequence<int>& s)
 {
   int n = s.size();
@@ -68,6 +68,20 @@ void load_in_order(Sequence<int>& s, int n);
 //----------------------------------------------------------------------
 void load_reverse_order(Sequence<int>& s, int n);
 
+//----------------------------------------------------------------------
+// Initialize the sequence with n values drawn from only k distinct
+// keys (1 to k), in a scrambled order. Assumes the sequence is empty.
+//
+// Inputs:
+//   s -- the sequence to add data to
+//   n -- the number of elements to add to the sequence
+//   k -- the number of distinct values
+//
+// Outputs:
+//   s -- the sequence is loaded with duplicate-heavy data
+//----------------------------------------------------------------------
+void load_few_unique(Sequence<int>& s, int n, int k);
+
 //----------------------------------------------------------------------
 // Reset the sequence with the values 1 to n. Assumes the sequence is
 // already loaded (just resetting the values).
@@ -0,0 +1,162 @@
+//---------------------------------------------------------------------------
+// NAME: Joey Macauley
+// FILE: workpool.h
+// DATE: CPSC 223 - Spring 2022
+// DESC: A small work-stealing thread pool for the parallel sorts. Each
+//       worker owns a deque of tasks: it pushes and pops its own tasks
+//       at the bottom (newest first, so it stays on cache-warm data)
+//       and steals from the top of other workers' deques (oldest
+//       first, which tend to be the biggest pieces of work) when it
+//       runs out.
+//---------------------------------------------------------------------------
+
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class WorkStealingPool
+{
+public:
+  // A unit of work. Called with the pool and the index of the worker
+  // running it, which is what spawn() and help_until_zero() expect.
+  typedef std::function<void(WorkStealingPool &, int)> Task;
+
+  // Runs root on a pool of the given number of threads (including the
+  // calling thread) and returns once root and every task spawned from
+  // it have finished.
+  static void run(int threads, Task root);
+
+  // Queues a task on the given worker's deque. Must be called from a
+  // task running on that worker.
+  void spawn(int worker, Task task);
+
+  // Runs local or stolen tasks on the given worker until count drops
+  // to zero. Used by a task to wait for tasks it spawned without
+  // idling the worker.
+  void help_until_zero(int worker, const std::atomic<int> &count);
+
+  // Returns the number of workers in the pool
+  int thread_count() const;
+
+private:
+  explicit WorkStealingPool(int threads);
+  ~WorkStealingPool();
+
+  // per-worker task deque
+  struct WorkerDeque
+  {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  // runs one task from the worker's own deque or stolen from another
+  // worker, returns false if there was nothing to run
+  bool run_one(int worker);
+
+  // worker deques
+  WorkerDeque *deques = nullptr;
+
+  // number of workers
+  int threads = 0;
+
+  // tasks spawned but not yet finished
+  std::atomic<int> pending{0};
+};
+
+inline WorkStealingPool::WorkStealingPool(int threads)
+    : deques(new WorkerDeque[threads]), threads(threads)
+{
+}
+
+inline WorkStealingPool::~WorkStealingPool()
+{
+  delete[] deques;
+}
+
+inline void WorkStealingPool::run(int threads, Task root)
+{
+  if (threads < 1)
+  {
+    threads = 1;
+  }
+  WorkStealingPool pool(threads);
+  pool.spawn(0, std::move(root));
+
+  std::thread *workers = new std::thread[threads - 1];
+  for (int t = 1; t < threads; ++t)
+  {
+    workers[t - 1] = std::thread([&pool, t]() {
+      pool.help_until_zero(t, pool.pending);
+    });
+  }
+  pool.help_until_zero(0, pool.pending);
+  for (int t = 1; t < threads; ++t)
+  {
+    workers[t - 1].join();
+  }
+  delete[] workers;
+}
+
+inline void WorkStealingPool::spawn(int worker, Task task)
+{
+  pending.fetch_add(1);
+  std::lock_guard<std::mutex> guard(deques[worker].lock);
+  deques[worker].tasks.push_back(std::move(task));
+}
+
+inline void WorkStealingPool::help_until_zero(int worker,
+                                              const std::atomic<int> &count)
+{
+  while (count.load() > 0)
+  {
+    if (not run_one(worker))
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+inline int WorkStealingPool::thread_count() const
+{
+  return threads;
+}
+
+inline bool WorkStealingPool::run_one(int worker)
+{
+  Task task;
+  bool found = false;
+  {
+    std::lock_guard<std::mutex> guard(deques[worker].lock);
+    if (not deques[worker].tasks.empty())
+    {
+      task = std::move(deques[worker].tasks.back());
+      deques[worker].tasks.pop_back();
+      found = true;
+    }
+  }
+  for (int i = 1; i < threads and not found; ++i)
+  {
+    WorkerDeque &victim = deques[(worker + i) % threads];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (not victim.tasks.empty())
+    {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      found = true;
+    }
+  }
+  if (not found)
+  {
+    return false;
+  }
+  task(*this, worker);
+  pending.fetch_sub(1);
+  return true;
+}
+
+#endif